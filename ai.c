@@ -1,70 +1,317 @@
+#define _POSIX_C_SOURCE 200809L /* clock_gettime */
+
 #include "ai.h"
 
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mcts.h"
+#include "tt.h"
+
+#define AI_POLL_NODES 1024 /* nos entre consultas ao relogio */
+
+#define AI_MAX_PLY (AI_MAX_DEPTH + 32) /* alturas com killers */
+#define AI_MAX_PV AI_MAX_DEPTH		   /* alturas com variante principal */
+/* lances na pilha de listas de uma thread: cada altura usa so o estagio
+   gerado (poucas dezenas em partidas reais, 541 no pior caso medido) */
+#define AI_MOVE_STACK (AI_MAX_PLY * 128)
+
+#define AI_NULL_MIN_DEPTH 3		  /* profundidade minima para tentar o lance nulo */
+#define AI_NULL_MIN_JAGUAR_MOVES 3 /* onca com menos lances: quase presa, sem lance nulo */
+#define AI_LMR_MIN_DEPTH 3		  /* profundidade minima para reduzir */
+#define AI_LMR_MIN_MOVES 3		  /* lances buscados antes de reduzir */
+#define AI_FUTILITY_MARGIN 60	  /* margem por unidade de profundidade (depth <= 2) */
+#define AI_HISTORY_MAX (1 << 24)	   /* acima disso a historia eh reduzida a metade */
+
+#define AI_YBW_MIN_DEPTH 4		 /* profundidade minima de um ponto de divisao */
+#define AI_YBW_DEQUE_SIZE 1024 /* tarefas na fila de cada thread */
+
+typedef struct AiSplit AiSplit;
+
+/* ponto de divisao (YBW): no cujo filho mais velho ja foi buscado e cujos
+   irmaos viraram tarefas. Fica na pilha de quem dividiu, que so retorna
+   depois que todas as tarefas terminarem */
+struct AiSplit {
+	Game game; /* posicao do no; cada tarefa trabalha numa copia */
+	int depth;
+	int ply;
+	int maximizing;
+	AiSplit* parent; /* ponto de divisao acima deste, ou NULL */
+
+	atomic_int cut;		/* houve corte: os irmaos restantes desistem */
+	atomic_int pending; /* tarefas ainda nao concluidas */
+
+	pthread_mutex_t lock; /* protege os campos abaixo */
+	int alpha;
+	int beta;
+	int best_score;
+	Move best_move;
+	Move pv[AI_MAX_DEPTH]; /* variante do melhor lance vindo de uma tarefa */
+	int pv_len;
+	int error;
+};
+
+/* buscar o lance mv no ponto de divisao sp */
+typedef struct {
+	AiSplit* sp;
+	Move mv;
+} AiTask;
+
+/* fila de tarefas de uma thread: a dona poe e tira no fim, as outras
+   roubam do comeco (tarefas mais antigas, em geral mais perto da raiz) */
+typedef struct {
+	pthread_mutex_t lock;
+	AiTask tasks[AI_YBW_DEQUE_SIZE];
+	size_t head; /* primeira tarefa (indice sem modulo) */
+	size_t tail; /* uma depois da ultima               */
+} AiDeque;
+
+/* pool do YBW: uma fila por thread (a 0 eh a chamadora) */
+typedef struct {
+	int nthreads;
+	AiDeque* deques;
+	atomic_int done; /* fim da busca: prazo estourado ou a thread 0 terminou */
+} AiPool;
+
+/* estado de uma busca (de uma thread): configuracao, prazo e contadores.
+   Nada aqui eh compartilhado, exceto a tabela e o pedido de parada */
+typedef struct {
+	const AiConfig* cfg;
+	TransTable* tt; /* tabela compartilhada, ou NULL */
+
+	long long start_ms;	   /* inicio da busca (ai_now_ms) */
+	long long deadline_ms; /* instante limite, ou 0 sem limite */
+	int can_stop;		   /* 0 enquanto nao ha nenhuma iteracao completa */
+	int stopped;		   /* prazo estourou: resultados parciais invalidos */
+	atomic_int* abort;	   /* pedido de parada vindo de outra thread, ou NULL */
+
+	AiPool* pool;	/* YBW: pool de threads, ou NULL */
+	int thread_id;	/* indice da fila desta thread no pool */
+	AiSplit* split; /* ponto de divisao da tarefa em andamento, ou NULL */
+
+	long long nodes;
+
+	/* ordenacao: lances simples que causaram corte */
+	Move killers[AI_MAX_PLY][GAME_MAX_KILLERS]; /* por altura na arvore */
+	int history[2][GAME_HISTORY_SIZE];			/* [lado][from * V + to] */
+
+	unsigned char null_at[AI_MAX_PLY]; /* lance nulo feito nesta altura */
+
+	/* variante principal triangular: pv[ply] comeca no lance da altura ply */
+	Move pv[AI_MAX_PV][AI_MAX_PV];
+	int pv_len[AI_MAX_PV];
+
+	/* memoria dos geradores: cada no guarda a sua lista em move_stack a
+	   partir de move_top, do tamanho do estagio gerado, e devolve o espaco
+	   ao sair; os filhos usam o que vem depois */
+	GameJumpTable jumps;
+	Move move_stack[AI_MOVE_STACK];
+	int move_top;
+} AiSearch;
+
+/* relogio monotono em milissegundos */
+static long long ai_now_ms (void) {
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
 
-#define AI_MAX_MOVES 128
+static void ai_search_init (AiSearch* s, const AiConfig* cfg, TransTable* tt) {
+	s->cfg = cfg;
+	s->tt = tt;
+	s->start_ms = ai_now_ms ();
+	s->deadline_ms = cfg->time_ms > 0 ? s->start_ms + cfg->time_ms : 0;
+	s->can_stop = 0;
+	s->stopped = 0;
+	s->abort = NULL;
+	s->pool = NULL;
+	s->thread_id = 0;
+	s->split = NULL;
+	s->nodes = 0;
+	s->move_top = 0;
+
+	memset (s->killers, 0, sizeof s->killers);
+	memset (s->pv_len, 0, sizeof s->pv_len);
+	memset (s->null_at, 0, sizeof s->null_at);
+	memset (s->history, 0, sizeof s->history);
+}
 
-/* conta quantos movimentos o lado "side" tem a partir do estado atual */
-static int ai_count_moves_for_side (const Game* game, CellContent side) {
-	Game tmp = *game; /* copia local para nao mexer no original */
-	tmp.to_move = side;
+static int ai_side_index (CellContent side) {
+	return side == CELL_DOG ? 0 : 1;
+}
 
-	Move moves[AI_MAX_MOVES];
-	int count = 0;
+/* lance simples mv causou corte na altura ply com profundidade depth */
+static void ai_record_cutoff (AiSearch* s, Move mv, int depth, int ply) {
+	if ( move_type (mv) != MOVE_SIMPLE )
+		return; /* capturas ja vem primeiro */
 
-	if ( game_generate_moves (&tmp, moves, AI_MAX_MOVES, &count) != 0 ) {
-		fprintf (stderr,
-				 "ai_count_moves_for_side: game_generate_moves falhou\n");
-		return 0;
+	if ( ply < AI_MAX_PLY && s->killers[ply][0] != mv ) {
+		for ( int k = GAME_MAX_KILLERS - 1; k > 0; k-- )
+			s->killers[ply][k] = s->killers[ply][k - 1];
+		s->killers[ply][0] = mv;
 	}
 
-	return count;
+	int* h = s->history[ai_side_index (move_side (mv))];
+	int* slot = &h[move_from (mv) * GRAPH_MAX_VERTICES + move_to (mv)];
+
+	*slot += depth * depth;
+	if ( *slot > AI_HISTORY_MAX ) {
+		for ( int i = 0; i < GAME_HISTORY_SIZE; i++ )
+			h[i] /= 2;
+	}
 }
 
-int ai_count_dogs_adjacent_to_jaguar (const Game* game) {
-	int jpos = game->jaguar_pos;
-	if ( jpos < 0 || jpos >= game->g.num_vertices )
-		return 0;
+/* 1 se houve corte em sp ou num ponto de divisao acima dele */
+static int ai_split_cut (const AiSplit* sp) {
+	for ( ; sp; sp = sp->parent ) {
+		if ( atomic_load_explicit (&sp->cut, memory_order_relaxed) )
+			return 1;
+	}
+	return 0;
+}
+
+/* conta o no e, de tempos em tempos, confere o prazo e o pedido de parada */
+static int ai_search_should_stop (AiSearch* s) {
+	if ( s->stopped )
+		return 1;
 
-	int neigh[GRAPH_MAX_NEIGHBORS];
-	int deg = 0;
+	/* YBW: um corte acima torna esta subarvore inutil (conferido em todo
+	   no, para liberar a thread logo) */
+	if ( s->split && ai_split_cut (s->split) ) {
+		s->stopped = 1;
+		return 1;
+	}
+
+	if ( (++s->nodes & (AI_POLL_NODES - 1)) == 0 ) {
+		if ( s->abort && atomic_load_explicit (s->abort, memory_order_relaxed) ) {
+			s->stopped = 1;
+		} else if ( s->deadline_ms && s->can_stop && ai_now_ms () >= s->deadline_ms ) {
+			s->stopped = 1;
+			if ( s->abort ) /* YBW: avisa as threads do pool */
+				atomic_store (s->abort, 1);
+		}
+	}
 
-	if ( graph_get_neighbors (&game->g, jpos, neigh, &deg) != 0 )
+	return s->stopped;
+}
+
+/* tabela de transposicao compartilhada por todas as buscas (e threads),
+   recriada quando cfg->tt_mb muda e nenhuma busca esta em andamento.
+   A trava protege so a troca da tabela; o acesso as entradas eh sem trava */
+static TransTable ai_tt;
+static int ai_tt_mb = 0;
+static int ai_tt_users = 0;
+static pthread_mutex_t ai_tt_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void ai_config_default (AiConfig* cfg) {
+	cfg->max_depth = 6;
+	cfg->side = CELL_JAGUAR;
+	cfg->tt_mb = AI_DEFAULT_TT_MB;
+	cfg->time_ms = 0;
+	cfg->algorithm = AI_ALGO_PVS;
+	cfg->quiescence = AI_QS_BLOCKS;
+	cfg->null_move = 1;
+	cfg->lmr = 1;
+	cfg->futility = 1;
+	cfg->threads = 1;
+	cfg->parallel = AI_PAR_LAZY_SMP;
+	cfg->tablebase = NULL;
+	cfg->engine = AI_ENGINE_ALPHABETA;
+	cfg->playout = AI_PLAYOUT_HEURISTIC;
+	cfg->mcts_mb = AI_DEFAULT_MCTS_MB;
+	cfg->mcts_playouts = 0;
+}
+
+void ai_release (void) {
+	pthread_mutex_lock (&ai_tt_lock);
+	if ( ai_tt_users == 0 ) {
+		tt_destroy (&ai_tt);
+		ai_tt_mb = 0;
+	}
+	pthread_mutex_unlock (&ai_tt_lock);
+
+	mcts_release ();
+}
+
+/* reserva a tabela para uma busca, com o tamanho pedido em cfg quando
+   possivel; *out fica NULL com cfg->tt_mb == 0. Liberar com ai_tt_done */
+static int ai_tt_acquire (const AiConfig* cfg, TransTable** out) {
+	*out = NULL;
+	if ( cfg->tt_mb <= 0 )
 		return 0;
 
-	int count = 0;
+	pthread_mutex_lock (&ai_tt_lock);
+
+	/* com outra busca em andamento a tabela atual fica como esta */
+	if ( cfg->tt_mb != ai_tt_mb && ai_tt_users == 0 ) {
+		tt_destroy (&ai_tt);
+		ai_tt_mb = 0;
+
+		if ( tt_create (&ai_tt, (size_t)cfg->tt_mb) != 0 ) {
+			pthread_mutex_unlock (&ai_tt_lock);
+			fprintf (stderr, "ai_tt_acquire: tt_create falhou (%d MB)\n", cfg->tt_mb);
+			return -1;
+		}
+		ai_tt_mb = cfg->tt_mb;
+	}
 
-	for ( int i = 0; i < deg; i++ ) {
-		int vid = neigh[i];
-		if ( game->cell_at[vid] == CELL_DOG )
-			count++;
+	if ( ai_tt.buckets ) {
+		/* nova busca: o que ficou das anteriores passa a ceder lugar */
+		if ( ai_tt_users == 0 )
+			tt_new_search (&ai_tt);
+		ai_tt_users++;
+		*out = &ai_tt;
 	}
 
-	return count;
+	pthread_mutex_unlock (&ai_tt_lock);
+	return 0;
+}
+
+static void ai_tt_done (TransTable* tt) {
+	if ( !tt )
+		return;
+
+	pthread_mutex_lock (&ai_tt_lock);
+	ai_tt_users--;
+	pthread_mutex_unlock (&ai_tt_lock);
 }
 
+int ai_count_dogs_adjacent_to_jaguar (const Game* game) {
+	int jpos = game->jaguar_pos;
+	if ( jpos < 0 || jpos >= game->g->num_vertices )
+		return 0;
+
+	return bb_popcount (game->g->v[jpos].adj & game->dogs);
+}
+
+/* O(1) por folha: nada de gerar lances. O que dependia da posicao de
+   cada peca (grau e saltos da onca, seguranca e alcance dos caes) esta
+   nas tabelas por vertice de Game.psq, somadas incrementalmente */
 int ai_evaluate (const Game* game, CellContent side) {
 	/* 1) material */
-	int mat = 13 - game->num_dogs; /* maior = melhor pra onca */
-
-	/* 2) mobilidade da onca */
-	int jag_moves = ai_count_moves_for_side (game, CELL_JAGUAR); /* funcao helper */
+	int mat = 13 - game_num_dogs (game); /* maior = melhor pra onca */
 
-	/* 3) mobilidade dos caes */
-	int dog_moves = ai_count_moves_for_side (game, CELL_DOG); /* helper */
+	/* 2) tabelas por vertice (onca e caes), ja somadas em make/unmake */
+	int psq = game->psq;
 
-	/* 4) vizinhos da onca (grau) */
-	int deg_jag = graph_degree (&game->g, game->jaguar_pos);
+	/* 3) liberdade imediata da onca: vizinhos vazios e saltos disponiveis */
+	int jag_free = 0;
+	if ( game->jaguar_pos >= 0 ) {
+		Bitboard empty = game_empty_mask (game);
+		jag_free = bb_popcount (game->g->v[game->jaguar_pos].adj & empty) +
+				   bb_popcount (game_jaguar_threats (game));
+	}
 
-	/* 5) caes adjacentes à onca */
+	/* 4) caes adjacentes à onca */
 	int dogs_adj = ai_count_dogs_adjacent_to_jaguar (game);
 
-	/* combinacao linear simples (ajusta pesos depois) */
-	int score_onca =
-		30 * mat /* peso maior no material */
-		+ 3 * jag_moves - 2 * dog_moves + 2 * deg_jag - 5 * dogs_adj;
-
-	/* se quiser, pode clamp: limitar score entre -20000 e 20000, etc */
+	int score_onca = 30 * mat /* peso maior no material */
+					 + psq + 3 * jag_free - 5 * dogs_adj;
 
 	if ( side == CELL_JAGUAR )
 		return score_onca;
@@ -75,8 +322,32 @@ int ai_evaluate (const Game* game, CellContent side) {
 	return 0;
 }
 
-/* avalia estado terminal ou retorna 0 se nao for terminal */
-static int ai_eval_terminal (const Game* game, const AiConfig* cfg, int* out_score) {
+/* vitoria a plies meias jogadas da raiz (ver AI_WIN_RANGE); finais alem
+   do alcance ficam no limite e continuam valendo como vitoria */
+static inline int ai_win_in (int plies) {
+	return AI_WIN_SCORE - (plies < AI_WIN_RANGE ? plies : AI_WIN_RANGE - 1);
+}
+
+/* a tabela de transposicao guarda vitorias contadas a partir do no, nao
+   da raiz: a mesma posicao pode aparecer em outra altura */
+static inline int ai_score_to_tt (int score, int ply) {
+	if ( score > AI_WIN_SCORE - AI_WIN_RANGE )
+		return score + ply;
+	if ( score < AI_LOSE_SCORE + AI_WIN_RANGE )
+		return score - ply;
+	return score;
+}
+
+static inline int ai_score_from_tt (int score, int ply) {
+	if ( score > AI_WIN_SCORE - AI_WIN_RANGE )
+		return score - ply;
+	if ( score < AI_LOSE_SCORE + AI_WIN_RANGE )
+		return score + ply;
+	return score;
+}
+
+/* avalia estado terminal (na altura ply) ou retorna 0 se nao for terminal */
+static int ai_eval_terminal (const Game* game, const AiConfig* cfg, int ply, int* out_score) {
 	CellContent winner;
 
 	if ( game_get_winner (game, &winner) != 1 )
@@ -88,17 +359,20 @@ static int ai_eval_terminal (const Game* game, const AiConfig* cfg, int* out_sco
 	}
 
 	if ( winner == cfg->side )
-		*out_score = AI_WIN_SCORE;
+		*out_score = ai_win_in (ply);
 	else
-		*out_score = AI_LOSE_SCORE;
+		*out_score = -ai_win_in (ply);
 
 	return 1;
 }
 
-int ai_minimax (const Game* game, int depth, int maximizing, const AiConfig* cfg, int* out_score) {
+/* MINIMAX sobre um unico estado, modificado com make/unmake e restaurado ao sair */
+static int ai_minimax_rec (Game* game, int depth, int ply, int maximizing, AiSearch* s, int* out_score) {
+	const AiConfig* cfg = s->cfg;
+
 	/* 1) testa estado terminal */
 	int terminal_score;
-	if ( ai_eval_terminal (game, cfg, &terminal_score) ) {
+	if ( ai_eval_terminal (game, cfg, ply, &terminal_score) ) {
 		*out_score = terminal_score;
 		return 0;
 	}
@@ -110,17 +384,18 @@ int ai_minimax (const Game* game, int depth, int maximizing, const AiConfig* cfg
 	}
 
 	/* 3) gera movimentos */
-	Move moves[AI_MAX_MOVES];
+	int top = s->move_top;
+	Move* moves = &s->move_stack[top];
 	int count = 0;
 
-	if ( game_generate_moves (game, moves, AI_MAX_MOVES, &count) != 0 ) {
+	if ( game_generate_moves (game, moves, AI_MOVE_STACK - top, &count, &s->jumps) != 0 ) {
 		fprintf (stderr, "ai_minimax: game_generate_moves falhou\n");
 		return -2;
 	}
 
 	/* sem movimentos -> trata como terminal (empate ou derrota) */
 	if ( count == 0 ) {
-		if ( ai_eval_terminal (game, cfg, &terminal_score) ) {
+		if ( ai_eval_terminal (game, cfg, ply, &terminal_score) ) {
 			*out_score = terminal_score;
 		} else {
 			/* sem movimentos mas nao marcado como terminal:
@@ -131,203 +406,1073 @@ int ai_minimax (const Game* game, int depth, int maximizing, const AiConfig* cfg
 	}
 
 	/* 4) recursao minimax */
-	int best_score;
+	int best_score = maximizing ? AI_LOSE_SCORE : AI_WIN_SCORE;
 
-	if ( maximizing ) {
-		best_score = AI_LOSE_SCORE;
+	s->move_top = top + count;
+	for ( int i = 0; i < count; i++ ) {
+		GameUndo undo;
 
-		for ( int i = 0; i < count; i++ ) {
-			Game child = *game;
+		if ( game_make_move (game, moves[i], &undo) != 0 ) {
+			fprintf (stderr, "ai_minimax: game_make_move falhou\n");
+			continue;
+		}
 
-			if ( game_apply_move (&child, &moves[i]) != 0 ) {
-				fprintf (stderr,
-						 "ai_minimax: game_apply_move falhou (max branch)\n");
-				continue;
-			}
+		int child_score;
+		int err = ai_minimax_rec (game, depth - 1, ply + 1, !maximizing, s, &child_score);
 
-			int child_score;
-			if ( ai_minimax (&child, depth - 1, 0, cfg, &child_score) != 0 )
-				return -3;
+		game_unmake_move (game, moves[i], &undo);
 
-			if ( child_score > best_score )
-				best_score = child_score;
+		if ( err != 0 ) {
+			s->move_top = top;
+			return maximizing ? -3 : -4;
 		}
-	} else {
-		best_score = AI_WIN_SCORE;
 
-		for ( int i = 0; i < count; i++ ) {
-			Game child = *game;
+		if ( maximizing ? child_score > best_score : child_score < best_score )
+			best_score = child_score;
+	}
+	s->move_top = top;
+
+	*out_score = best_score;
+	return 0;
+}
+
+int ai_minimax (const Game* game, int depth, int maximizing, const AiConfig* cfg, int* out_score) {
+	AiSearch* s = malloc (sizeof *s);
+	if ( !s )
+		return -6;
+
+	ai_search_init (s, cfg, NULL);
+
+	Game work = *game; /* unica copia: a busca anda nela com make/unmake */
+	int err = ai_minimax_rec (&work, depth, 0, maximizing, s, out_score);
+
+	free (s);
+	return err;
+}
+
+static int ai_alphabeta_rec (Game* game, int depth, int ply, int alpha, int beta, int maximizing, AiSearch* s, int* out_score);
+
+/* busca um filho (na altura ply) de um no que maximiza (maximizing) ou
+   minimiza, com a janela [alpha, beta] do pai. Em PVS so o primeiro filho usa a janela
+   cheia; os demais usam janela nula, que apenas prova que o lance nao
+   supera o melhor ate aqui, e so sao rebuscados se a prova falhar */
+static int ai_search_child (Game* game, int depth, int ply, int alpha, int beta, int maximizing, int first,
+							AiSearch* s, int* out_score) {
+	if ( first || s->cfg->algorithm != AI_ALGO_PVS )
+		return ai_alphabeta_rec (game, depth, ply, alpha, beta, !maximizing, s, out_score);
+
+	int err;
+	if ( maximizing )
+		err = ai_alphabeta_rec (game, depth, ply, alpha, alpha + 1, 0, s, out_score);
+	else
+		err = ai_alphabeta_rec (game, depth, ply, beta - 1, beta, 1, s, out_score);
+
+	if ( err != 0 || s->stopped )
+		return err;
+
+	if ( *out_score > alpha && *out_score < beta )
+		err = ai_alphabeta_rec (game, depth, ply, alpha, beta, !maximizing, s, out_score);
+
+	return err;
+}
+
+/* mv melhorou o no na altura ply: a variante principal dele passa a ser
+   mv seguido da variante do filho */
+static void ai_pv_update (AiSearch* s, int ply, Move mv) {
+	if ( ply >= AI_MAX_PV )
+		return;
+
+	s->pv[ply][0] = mv;
+	int len = 1;
+
+	if ( ply + 1 < AI_MAX_PV ) {
+		for ( int k = 0; k < s->pv_len[ply + 1] && len < AI_MAX_PV; k++ )
+			s->pv[ply][len++] = s->pv[ply + 1][k];
+	}
+
+	s->pv_len[ply] = len;
+}
+
+/* coloca moves[best] na frente e os demais em ordem de scores (do ponto de
+   vista de quem maximiza na raiz), mantendo a ordem anterior nos empates */
+static void ai_sort_root (Move moves[], int scores[], int count, int best, int maximizing_root) {
+	Move bm = moves[best];
+	int bs = scores[best];
 
-			if ( game_apply_move (&child, &moves[i]) != 0 ) {
-				fprintf (stderr,
-						 "ai_minimax: game_apply_move falhou (min branch)\n");
-				continue;
+	for ( int i = best; i > 0; i-- ) {
+		moves[i] = moves[i - 1];
+		scores[i] = scores[i - 1];
+	}
+	moves[0] = bm;
+	scores[0] = bs;
+
+	for ( int i = 2; i < count; i++ ) {
+		Move m = moves[i];
+		int sc = scores[i];
+		int j = i;
+
+		while ( j > 1 && (maximizing_root ? sc > scores[j - 1] : sc < scores[j - 1]) ) {
+			moves[j] = moves[j - 1];
+			scores[j] = scores[j - 1];
+			j--;
+		}
+
+		moves[j] = m;
+		scores[j] = sc;
+	}
+}
+
+/* lance nulo arriscado quando a onca esta quase presa: ali ter a vez
+   decide o jogo (zugzwang), e passar daria um valor falso */
+static int ai_null_move_safe (const Game* game) {
+	if ( game->jaguar_pos < 0 )
+		return 0;
+
+	const Vertex* v = &game->g->v[game->jaguar_pos];
+	return bb_popcount (v->adj & game_empty_mask (game)) >= AI_NULL_MIN_JAGUAR_MOVES;
+}
+
+/* quiescencia: alem da profundidade nominal so seguem as capturas da onca
+   (e, com AI_QS_BLOCKS, caes que ocupam o destino de um salto iminente),
+   ate a posicao ficar quieta. Quem joga pode sempre parar ("stand pat")
+   com a avaliacao estatica */
+static int ai_quiesce (Game* game, int ply, int alpha, int beta, int maximizing, AiSearch* s, int* out_score) {
+	const AiConfig* cfg = s->cfg;
+
+	if ( ply < AI_MAX_PV )
+		s->pv_len[ply] = 0;
+
+	if ( ai_search_should_stop (s) ) {
+		*out_score = 0;
+		return 0;
+	}
+
+	int terminal_score;
+	if ( ai_eval_terminal (game, cfg, ply, &terminal_score) ) {
+		*out_score = terminal_score;
+		return 0;
+	}
+
+	int stand = ai_evaluate (game, cfg->side);
+
+	if ( maximizing ? stand >= beta : stand <= alpha ) {
+		*out_score = stand;
+		return 0;
+	}
+
+	if ( ply >= AI_MAX_PLY ) {
+		*out_score = stand;
+		return 0;
+	}
+
+	int top = s->move_top;
+	Move* moves = &s->move_stack[top];
+	int count = 0;
+
+	if ( game->to_move == CELL_JAGUAR ) {
+		if ( game_generate_captures (game, moves, AI_MOVE_STACK - top, &count, &s->jumps) != 0 )
+			return -2;
+	} else if ( cfg->quiescence == AI_QS_BLOCKS ) {
+		Bitboard threats = game_jaguar_threats (game);
+
+		if ( threats ) {
+			int nq = 0;
+
+			if ( game_generate_quiets (game, moves, AI_MOVE_STACK - top, &nq) != 0 )
+				return -2;
+
+			/* filtra no mesmo lugar: count nunca passa de i */
+			for ( int i = 0; i < nq; i++ ) {
+				if ( bb_test (threats, move_to (moves[i])) )
+					moves[count++] = moves[i];
 			}
+		}
+	}
 
-			int child_score;
-			if ( ai_minimax (&child, depth - 1, 1, cfg, &child_score) != 0 )
-				return -4;
+	int best_score = stand;
+	if ( maximizing ) {
+		if ( stand > alpha )
+			alpha = stand;
+	} else {
+		if ( stand < beta )
+			beta = stand;
+	}
+
+	s->move_top = top + count;
+	for ( int i = 0; i < count; i++ ) {
+		GameUndo undo;
+
+		if ( game_make_move (game, moves[i], &undo) != 0 )
+			continue;
+
+		int child_score;
+		int err = ai_quiesce (game, ply + 1, alpha, beta, !maximizing, s, &child_score);
+
+		game_unmake_move (game, moves[i], &undo);
+
+		if ( err != 0 || s->stopped ) {
+			s->move_top = top;
+			*out_score = 0;
+			return err;
+		}
 
+		if ( maximizing ) {
+			if ( child_score > best_score )
+				best_score = child_score;
+			if ( child_score > alpha )
+				alpha = child_score;
+		} else {
 			if ( child_score < best_score )
 				best_score = child_score;
+			if ( child_score < beta )
+				beta = child_score;
 		}
+
+		if ( alpha >= beta )
+			break;
 	}
+	s->move_top = top;
 
 	*out_score = best_score;
 	return 0;
 }
 
-int ai_alphabeta (const Game* game, int depth, int alpha, int beta, int maximizing, const AiConfig* cfg, int* out_score) {
+/* ---- YBW: filas de tarefas e pontos de divisao ---- */
+
+/* 1 se sp esta abaixo de (ou eh) within; within NULL aceita qualquer um */
+static int ai_split_under (const AiSplit* sp, const AiSplit* within) {
+	if ( !within )
+		return 1;
+
+	for ( ; sp; sp = sp->parent ) {
+		if ( sp == within )
+			return 1;
+	}
+	return 0;
+}
+
+static int ai_deque_push (AiDeque* d, AiTask task) {
+	int ok = 0;
+
+	pthread_mutex_lock (&d->lock);
+	if ( d->tail - d->head < AI_YBW_DEQUE_SIZE ) {
+		d->tasks[d->tail++ % AI_YBW_DEQUE_SIZE] = task;
+		ok = 1;
+	}
+	pthread_mutex_unlock (&d->lock);
+
+	return ok;
+}
+
+/* tira uma tarefa do fim (dona) ou do comeco (ladra), se ela pertence a
+   within: quem espera um ponto de divisao so ajuda nas subarvores dele */
+static int ai_deque_take (AiDeque* d, int from_tail, const AiSplit* within, AiTask* out) {
+	int ok = 0;
+
+	pthread_mutex_lock (&d->lock);
+	if ( d->tail != d->head ) {
+		size_t i = from_tail ? d->tail - 1 : d->head;
+		AiTask* task = &d->tasks[i % AI_YBW_DEQUE_SIZE];
+
+		if ( ai_split_under (task->sp, within) ) {
+			*out = *task;
+			if ( from_tail )
+				d->tail--;
+			else
+				d->head++;
+			ok = 1;
+		}
+	}
+	pthread_mutex_unlock (&d->lock);
+
+	return ok;
+}
+
+/* proxima tarefa para a thread id: primeiro a propria fila, depois as
+   das outras, a partir da vizinha */
+static int ai_pool_take (AiPool* pool, int id, const AiSplit* within, AiTask* out) {
+	if ( ai_deque_take (&pool->deques[id], 1, within, out) )
+		return 1;
+
+	for ( int k = 1; k < pool->nthreads; k++ ) {
+		if ( ai_deque_take (&pool->deques[(id + k) % pool->nthreads], 0, within, out) )
+			return 1;
+	}
+	return 0;
+}
+
+/* busca um irmao mais novo e junta o valor no ponto de divisao */
+static void ai_ybw_run (AiSearch* s, AiTask task) {
+	AiSplit* sp = task.sp;
+
+	if ( !ai_split_cut (sp) && !atomic_load_explicit (s->abort, memory_order_relaxed) ) {
+		Game g = sp->game;
+		GameUndo undo;
+
+		if ( game_make_move (&g, task.mv, &undo) == 0 ) {
+			pthread_mutex_lock (&sp->lock);
+			int alpha = sp->alpha;
+			int beta = sp->beta;
+			pthread_mutex_unlock (&sp->lock);
+
+			AiSplit* saved = s->split;
+			int score = 0;
+
+			s->split = sp;
+			int err = ai_search_child (&g, sp->depth - 1, sp->ply + 1, alpha, beta, sp->maximizing, 0, s, &score);
+			s->split = saved;
+
+			pthread_mutex_lock (&sp->lock);
+			if ( err != 0 ) {
+				sp->error = err;
+			} else if ( !s->stopped ) {
+				int improved = sp->maximizing ? score > sp->best_score : score < sp->best_score;
+				if ( improved ) {
+					sp->best_score = score;
+					sp->best_move = task.mv;
+				}
+
+				/* como ai_pv_update, mas a variante fica no ponto de divisao */
+				if ( sp->maximizing ? score > sp->alpha : score < sp->beta ) {
+					if ( sp->maximizing )
+						sp->alpha = score;
+					else
+						sp->beta = score;
+
+					int child = sp->ply + 1;
+					sp->pv[0] = task.mv;
+					sp->pv_len = 1;
+					for ( int k = 0; child < AI_MAX_PV && k < s->pv_len[child] && sp->pv_len < AI_MAX_DEPTH; k++ )
+						sp->pv[sp->pv_len++] = s->pv[child][k];
+				}
+
+				if ( sp->alpha >= sp->beta ) {
+					atomic_store (&sp->cut, 1);
+					ai_record_cutoff (s, task.mv, sp->depth, sp->ply);
+				}
+			}
+			pthread_mutex_unlock (&sp->lock);
+
+			/* parada por corte vale so para esta tarefa; a do fim da busca fica */
+			s->stopped = atomic_load_explicit (s->abort, memory_order_relaxed);
+		}
+	}
+
+	atomic_fetch_sub_explicit (&sp->pending, 1, memory_order_release);
+}
+
+/* divide o no: o filho mais velho ja foi buscado (best_score/best_move)
+   sem corte; os demais lances de mp viram tarefas. A thread ajuda nas
+   subarvores deste no enquanto espera e no fim junta o resultado */
+static int ai_ybw_split (Game* game, MovePicker* mp, int depth, int ply, int alpha, int beta, int maximizing,
+						 AiSearch* s, int* best_score, Move* best_move) {
+	/* os lances restantes ficam fora da pilha de listas: o picker ainda
+	   pode gerar os simples no espaco dele, por cima do que viesse depois */
+	Move* rest = malloc (AI_MAX_MOVES * sizeof *rest);
+	int n = 0;
+	Move mv;
+
+	if ( !rest )
+		return -6;
+
+	while ( (mv = game_picker_next (mp)) != MOVE_NONE ) {
+		if ( n >= AI_MAX_MOVES ) {
+			free (rest);
+			return -2;
+		}
+		rest[n++] = mv;
+	}
+
+	if ( mp->error || n == 0 ) {
+		free (rest);
+		return mp->error ? -2 : 0;
+	}
+
+	AiSplit sp;
+	sp.game = *game;
+	sp.depth = depth;
+	sp.ply = ply;
+	sp.maximizing = maximizing;
+	sp.parent = s->split;
+	atomic_init (&sp.cut, 0);
+	atomic_init (&sp.pending, n);
+	pthread_mutex_init (&sp.lock, NULL);
+	sp.alpha = alpha;
+	sp.beta = beta;
+	sp.best_score = *best_score;
+	sp.best_move = *best_move;
+	sp.pv_len = 0;
+	sp.error = 0;
+
+	/* de tras para frente: a dona tira do fim e segue a ordem do picker,
+	   as ladras levam os ultimos lances. Fila cheia: busca aqui mesmo */
+	AiDeque* own = &s->pool->deques[s->thread_id];
+	for ( int i = n - 1; i >= 0; i-- ) {
+		AiTask task = { &sp, rest[i] };
+		if ( !ai_deque_push (own, task) )
+			ai_ybw_run (s, task);
+	}
+	free (rest);
+
+	while ( atomic_load_explicit (&sp.pending, memory_order_acquire) > 0 ) {
+		AiTask task;
+		if ( ai_pool_take (s->pool, s->thread_id, &sp, &task) )
+			ai_ybw_run (s, task);
+		else
+			sched_yield ();
+	}
+
+	pthread_mutex_destroy (&sp.lock);
+
+	/* as tarefas zeram a parada por corte: confere de novo a deste no */
+	if ( atomic_load_explicit (s->abort, memory_order_relaxed) || ai_split_cut (s->split) )
+		s->stopped = 1;
+
+	if ( sp.error != 0 )
+		return maximizing ? -3 : -4;
+
+	*best_score = sp.best_score;
+	*best_move = sp.best_move;
+
+	if ( sp.pv_len > 0 && ply < AI_MAX_PV ) {
+		int len = sp.pv_len < AI_MAX_PV ? sp.pv_len : AI_MAX_PV;
+		memcpy (s->pv[ply], sp.pv, (size_t)len * sizeof sp.pv[0]);
+		s->pv_len[ply] = len;
+	}
+
+	return 0;
+}
+
+/* alfa-beta sobre um unico estado, modificado com make/unmake e restaurado ao sair */
+static int ai_alphabeta_node (Game* game, int depth, int ply, int alpha, int beta, int maximizing, AiSearch* s,
+							  int* out_score) {
+	const AiConfig* cfg = s->cfg;
+	int top = s->move_top;
+
+	if ( ply < AI_MAX_PV )
+		s->pv_len[ply] = 0;
+
+	/* 0) prazo estourado: o valor sera descartado por quem chamou */
+	if ( ai_search_should_stop (s) ) {
+		*out_score = 0;
+		return 0;
+	}
+
 	/* 1) testa estado terminal */
 	int terminal_score;
-	if ( ai_eval_terminal (game, cfg, &terminal_score) ) {
+	if ( ai_eval_terminal (game, cfg, ply, &terminal_score) ) {
 		*out_score = terminal_score;
 		return 0;
 	}
 
-	/* 2) profundidade limite -> heuristica */
+	/* 1a) tabela de finais: valor exato, sem busca. Vitoria mais rapida
+	   (derrota mais demorada) vale mais; o fim fica a ply + tb_distance
+	   meias jogadas da raiz */
+	TBResult tb_result;
+	int tb_distance;
+	if ( cfg->tablebase && tb_probe (cfg->tablebase, game, &tb_result, &tb_distance) ) {
+		int tb_score = ai_win_in (ply + tb_distance);
+
+		if ( tb_result == TB_DRAW )
+			*out_score = 0;
+		else if ( (tb_result == TB_WIN) == (game->to_move == cfg->side) )
+			*out_score = tb_score;
+		else
+			*out_score = -tb_score;
+		return 0;
+	}
+
+	/* 2) profundidade limite -> heuristica (depois das capturas pendentes) */
 	if ( depth <= 0 ) {
+		if ( cfg->quiescence != AI_QS_OFF )
+			return ai_quiesce (game, ply, alpha, beta, maximizing, s, out_score);
+
 		*out_score = ai_evaluate (game, cfg->side);
 		return 0;
 	}
 
-	/* 3) gera movimentos */
-	Move moves[AI_MAX_MOVES];
-	int count = 0;
-
-	if ( game_generate_moves (game, moves, AI_MAX_MOVES, &count) != 0 ) {
-		fprintf (stderr, "ai_alphabeta: game_generate_moves falhou\n");
-		return -2;
+	/* 3) tabela de transposicao: guarda valores do ponto de vista de quem
+	   joga; aqui quem joga eh quem maximiza (persp = 1) ou minimiza */
+	int persp = maximizing ? 1 : -1;
+	int alpha_orig = alpha;
+	int beta_orig = beta;
+	Move hash_move = MOVE_NONE;
+	TTEntry tte;
+
+	/* a tabela guarda so a forma canonica (espelho): a chave eh a mesma
+	   para a posicao e o seu espelho, e o lance volta orientado */
+	int mirrored = s->tt ? game_mirror_needed (game) : 0;
+	uint64_t tt_key = mirrored ? game->mirror_key : game->key;
+
+	if ( s->tt && tt_probe (s->tt, tt_key, &tte) ) {
+		hash_move = mirrored ? game_mirror_move (game, tte.move) : tte.move;
+
+		if ( tte.depth >= depth ) {
+			int tt_score = persp * ai_score_from_tt (tte.score, ply);
+			int is_lower = (tte.bound == TT_LOWER) == maximizing; /* em termos de cfg->side */
+
+			if ( tte.bound == TT_EXACT || (is_lower ? tt_score >= beta : tt_score <= alpha) ) {
+				*out_score = tt_score;
+				return 0;
+			}
+		}
 	}
 
-	if ( count == 0 ) {
-		/* sem movimentos: trata como terminal / neutro */
-		if ( ai_eval_terminal (game, cfg, &terminal_score) ) {
-			*out_score = terminal_score;
-		} else {
-			*out_score = 0;
+	/* podas seletivas: so fora da variante principal (janela nula) e longe
+	   de taticas (onca com salto disponivel) */
+	int pv_node = beta - alpha > 1;
+	int tactical = game_jaguar_threats (game) != BB_EMPTY;
+	int static_eval = 0;
+	int have_eval = 0;
+
+	/* 3a) lance nulo: se mesmo passando a vez o valor passa de beta (ou fica
+	   abaixo de alfa, para quem minimiza), corta com busca reduzida. Nao vale
+	   com a onca quase presa, onde ter a vez decide (zugzwang) */
+	if ( cfg->null_move && !pv_node && !tactical && depth >= AI_NULL_MIN_DEPTH && ply > 0 &&
+		 ply < AI_MAX_PLY && !s->null_at[ply - 1] && ai_null_move_safe (game) ) {
+		static_eval = ai_evaluate (game, cfg->side);
+		have_eval = 1;
+
+		if ( maximizing ? static_eval >= beta : static_eval <= alpha ) {
+			int r = depth > 6 ? 3 : 2;
+			int null_score;
+			GameUndo nu;
+
+			game_make_null_move (game, &nu);
+			s->null_at[ply] = 1;
+
+			int err = maximizing
+						  ? ai_alphabeta_rec (game, depth - 1 - r, ply + 1, beta - 1, beta, 0, s, &null_score)
+						  : ai_alphabeta_rec (game, depth - 1 - r, ply + 1, alpha, alpha + 1, 1, s, &null_score);
+
+			s->null_at[ply] = 0;
+			game_unmake_null_move (game, &nu);
+
+			if ( err != 0 )
+				return err;
+
+			if ( s->stopped ) {
+				*out_score = 0;
+				return 0;
+			}
+
+			/* vitoria "provada" passando a vez nao eh confiavel: devolve so o limite */
+			if ( maximizing && null_score >= beta ) {
+				*out_score = beta;
+				return 0;
+			}
+			if ( !maximizing && null_score <= alpha ) {
+				*out_score = alpha;
+				return 0;
+			}
 		}
-		return 0;
 	}
 
-	/* 4) recursao minimax com poda alfa-beta */
-	int best_score;
+	/* 3b) futilidade: perto das folhas, se nem a avaliacao estatica mais
+	   uma margem alcanca a janela, lances simples nao sao buscados */
+	int futile = 0;
+	int futile_score = 0;
 
-	if ( maximizing ) {
-		best_score = AI_LOSE_SCORE;
+	if ( cfg->futility && !pv_node && !tactical && depth <= 2 ) {
+		if ( !have_eval )
+			static_eval = ai_evaluate (game, cfg->side);
 
-		for ( int i = 0; i < count; i++ ) {
-			Game child = *game;
+		int margin = AI_FUTILITY_MARGIN * depth;
+		futile_score = maximizing ? static_eval + margin : static_eval - margin;
+		futile = maximizing ? futile_score <= alpha : futile_score >= beta;
+	}
 
-			if ( game_apply_move (&child, &moves[i]) != 0 ) {
-				fprintf (stderr,
-						 "ai_alphabeta: game_apply_move falhou (max branch)\n");
-				continue;
-			}
+	/* 4) movimentos gerados sob demanda, em estagios (hash, capturas,
+	   killers, simples por historia): um corte logo no inicio evita
+	   gerar o resto */
+	MovePicker mp;
+	game_picker_init (&mp, game, hash_move, ply < AI_MAX_PLY ? s->killers[ply] : NULL,
+					  s->history[ai_side_index (game->to_move)], &s->move_stack[top], AI_MOVE_STACK - top,
+					  &s->jumps);
+
+	/* 5) recursao minimax com poda alfa-beta */
+	int best_score = maximizing ? AI_LOSE_SCORE : AI_WIN_SCORE;
+	Move best_move = MOVE_NONE;
+	int count = 0;
+	Move mv;
 
-			int child_score;
-			if ( ai_alphabeta (&child, depth - 1,
-							   alpha, beta, 0, cfg, &child_score) != 0 )
-				return -3;
+	while ( (mv = game_picker_next (&mp)) != MOVE_NONE ) {
+		GameUndo undo;
 
-			if ( child_score > best_score )
-				best_score = child_score;
+		count++;
+		s->move_top = top + mp.count; /* os filhos usam a pilha depois do estagio atual */
 
-			if ( child_score > alpha )
-				alpha = child_score;
+		int quiet = move_type (mv) == MOVE_SIMPLE && mv != hash_move;
 
-			if ( alpha >= beta )
-				break; /* poda */
+		if ( futile && quiet && best_move != MOVE_NONE ) {
+			/* o valor desse lance fica limitado pela estimativa */
+			if ( maximizing ? futile_score > best_score : futile_score < best_score )
+				best_score = futile_score;
+			continue;
 		}
-	} else {
-		best_score = AI_WIN_SCORE;
 
-		for ( int i = 0; i < count; i++ ) {
-			Game child = *game;
+		if ( game_make_move (game, mv, &undo) != 0 ) {
+			fprintf (stderr, "ai_alphabeta: game_make_move falhou\n");
+			continue;
+		}
 
-			if ( game_apply_move (&child, &moves[i]) != 0 ) {
-				fprintf (stderr,
-						 "ai_alphabeta: game_apply_move falhou (min branch)\n");
-				continue;
-			}
+		int child_score;
+		int err = 0;
+		int full = 1;
 
-			int child_score;
-			if ( ai_alphabeta (&child, depth - 1,
-							   alpha, beta, 1, cfg, &child_score) != 0 )
-				return -4;
+		/* 5a) LMR: simples que sairam tarde da ordenacao (depois de hash,
+		   capturas e killers) sao buscados com profundidade menor e janela
+		   nula; so se surpreenderem voltam a busca completa */
+		if ( cfg->lmr && depth >= AI_LMR_MIN_DEPTH && count > AI_LMR_MIN_MOVES && mp.stage == PICK_QUIETS &&
+			 !tactical && game->winner == CELL_EMPTY ) {
+			int r = (!pv_node && depth >= 6 && count > 3 * AI_LMR_MIN_MOVES) ? 2 : 1;
 
-			if ( child_score < best_score )
+			if ( maximizing )
+				err = ai_alphabeta_rec (game, depth - 1 - r, ply + 1, alpha, alpha + 1, 0, s, &child_score);
+			else
+				err = ai_alphabeta_rec (game, depth - 1 - r, ply + 1, beta - 1, beta, 1, s, &child_score);
+
+			full = err == 0 && !s->stopped && (maximizing ? child_score > alpha : child_score < beta);
+		}
+
+		if ( full && err == 0 && !s->stopped )
+			err = ai_search_child (game, depth - 1, ply + 1, alpha, beta, maximizing, count == 1, s, &child_score);
+
+		game_unmake_move (game, mv, &undo);
+
+		if ( err != 0 )
+			return maximizing ? -3 : -4;
+
+		if ( s->stopped ) {
+			*out_score = 0;
+			return 0;
+		}
+
+		if ( maximizing ) {
+			if ( child_score > best_score || best_move == MOVE_NONE ) {
 				best_score = child_score;
+				best_move = mv;
+			}
 
-			if ( child_score < beta )
+			if ( child_score > alpha ) {
+				alpha = child_score;
+				ai_pv_update (s, ply, mv);
+			}
+		} else {
+			if ( child_score < best_score || best_move == MOVE_NONE ) {
+				best_score = child_score;
+				best_move = mv;
+			}
+
+			if ( child_score < beta ) {
 				beta = child_score;
+				ai_pv_update (s, ply, mv);
+			}
+		}
+
+		if ( alpha >= beta ) {
+			ai_record_cutoff (s, mv, depth, ply);
+			break; /* poda */
+		}
+
+		/* 5b) YBW: com o filho mais velho buscado, os irmaos se dividem
+		   entre as threads do pool */
+		if ( count == 1 && s->pool && depth >= AI_YBW_MIN_DEPTH ) {
+			int err = ai_ybw_split (game, &mp, depth, ply, alpha, beta, maximizing, s, &best_score, &best_move);
+			if ( err != 0 )
+				return err;
 
-			if ( alpha >= beta )
-				break; /* poda */
+			if ( s->stopped ) {
+				*out_score = 0;
+				return 0;
+			}
+			break;
 		}
 	}
 
+	/* lista incompleta: nem o valor nem "sem lances" seriam confiaveis */
+	if ( mp.error )
+		return -2;
+
+	if ( count == 0 ) {
+		/* sem movimentos: trata como terminal / neutro */
+		if ( ai_eval_terminal (game, cfg, ply, &terminal_score) ) {
+			*out_score = terminal_score;
+		} else {
+			*out_score = 0;
+		}
+		return 0;
+	}
+
+	if ( s->tt ) {
+		/* limite em termos de cfg->side, convertido para quem joga */
+		TTBound bound = TT_EXACT;
+		if ( best_score <= alpha_orig )
+			bound = maximizing ? TT_UPPER : TT_LOWER;
+		else if ( best_score >= beta_orig )
+			bound = maximizing ? TT_LOWER : TT_UPPER;
+
+		tt_store (s->tt, tt_key, depth, bound, ai_score_to_tt (persp * best_score, ply),
+				  mirrored ? game_mirror_move (game, best_move) : best_move);
+	}
+
 	*out_score = best_score;
 	return 0;
 }
 
-int ai_choose_move (const Game* game, const AiConfig* cfg, Move* best_move) {
-	Move moves[AI_MAX_MOVES];
-	int count = 0;
+static int ai_alphabeta_rec (Game* game, int depth, int ply, int alpha, int beta, int maximizing, AiSearch* s, int* out_score) {
+	/* o no devolve o espaco que usou na pilha de listas, saia por onde sair */
+	int top = s->move_top;
+	int err = ai_alphabeta_node (game, depth, ply, alpha, beta, maximizing, s, out_score);
+	s->move_top = top;
+	return err;
+}
 
-	if ( game_generate_moves (game, moves, AI_MAX_MOVES, &count) != 0 ) {
-		fprintf (stderr, "ai_choose_move: game_generate_moves falhou\n");
-		return -2;
+int ai_alphabeta (const Game* game, int depth, int alpha, int beta, int maximizing, const AiConfig* cfg, int* out_score) {
+	TransTable* tt;
+	if ( ai_tt_acquire (cfg, &tt) != 0 )
+		return -5;
+
+	AiSearch* s = malloc (sizeof *s);
+	if ( !s ) {
+		ai_tt_done (tt);
+		return -6;
 	}
 
-	if ( count <= 0 ) {
-		/* sem movimentos possiveis */
-		return 1;
-	}
+	ai_search_init (s, cfg, tt);
+	s->deadline_ms = 0; /* chamada direta: sem prazo, busca ate depth */
+
+	Game work = *game; /* unica copia: a busca anda nela com make/unmake */
+	int err = ai_alphabeta_rec (&work, depth, 0, alpha, beta, maximizing, s, out_score);
 
-	/* quem joga agora e maximizador se for o lado da IA */
-	int maximizing_root = (game->to_move == cfg->side) ? 1 : 0;
+	free (s);
+	ai_tt_done (tt);
+	return err;
+}
 
+/* uma iteracao na raiz com profundidade depth e janela [alpha, beta]:
+   o melhor valor ate aqui estreita a janela dos lances seguintes (que em
+   PVS usam janela nula). scores[] recebe o valor de cada lance (limite,
+   para os que nao superaram o melhor) e s->pv[0] a variante principal */
+static int ai_search_root (Game* work, const Move moves[], int scores[], int count, int depth, int alpha, int beta,
+						   int maximizing_root, AiSearch* s, int* out_idx, int* out_score) {
 	int best_score = maximizing_root ? AI_LOSE_SCORE : AI_WIN_SCORE;
 	int best_idx = 0;
 
+	s->pv_len[0] = 0;
+
 	for ( int i = 0; i < count; i++ ) {
-		Game child = *game;
+		GameUndo undo;
 
-		if ( game_apply_move (&child, &moves[i]) != 0 ) {
+		if ( game_make_move (work, moves[i], &undo) != 0 ) {
 			fprintf (stderr,
-					 "ai_choose_move: game_apply_move falhou no movimento %d\n",
+					 "ai_choose_move: game_make_move falhou no movimento %d\n",
 					 i);
 			continue;
 		}
 
 		int score = 0;
-		int alpha = AI_LOSE_SCORE;
-		int beta = AI_WIN_SCORE;
+		int err = ai_search_child (work, depth - 1, 1, alpha, beta, maximizing_root, i == 0, s, &score);
+
+		game_unmake_move (work, moves[i], &undo);
 
-		/* proximo nivel troca quem maximiza/minimiza */
-		int maximizing_next = maximizing_root ? 0 : 1;
+		if ( s->stopped )
+			return 0;
 
-		if ( ai_alphabeta (&child, cfg->max_depth - 1, alpha, beta, maximizing_next, cfg, &score) != 0 ) {
+		if ( err != 0 ) {
 			fprintf (stderr,
 					 "ai_choose_move: ai_alphabeta falhou no movimento %d\n",
 					 i);
 			continue;
 		}
 
+		scores[i] = score;
+
+		int improved = maximizing_root ? score > best_score : score < best_score;
+		if ( improved || i == 0 ) {
+			best_score = score;
+			best_idx = i;
+			ai_pv_update (s, 0, moves[i]);
+		}
+
 		if ( maximizing_root ) {
-			if ( score > best_score ) {
-				best_score = score;
-				best_idx = i;
-			}
+			if ( score > alpha )
+				alpha = score;
 		} else {
-			if ( score < best_score ) {
-				best_score = score;
-				best_idx = i;
+			if ( score < beta )
+				beta = score;
+		}
+
+		if ( alpha >= beta )
+			break; /* falhou alto na janela de aspiracao: sera rebuscada */
+	}
+
+	*out_idx = best_idx;
+	*out_score = best_score;
+	return 0;
+}
+
+/* uma thread de busca: estado proprio, copia propria do jogo e da lista
+   de lances da raiz; so a tabela de transposicao eh compartilhada */
+typedef struct {
+	AiSearch s;
+	Game work;
+
+	Move moves[AI_MAX_MOVES];
+	int scores[AI_MAX_MOVES];
+	int count;
+	int maximizing_root;
+	int start_depth; /* ajudantes comecam em profundidades alternadas */
+
+	AiResult result;
+	pthread_t thread;
+} AiWorker;
+
+/* aprofundamento iterativo de uma thread: cada iteracao completa vale
+   como resposta; a que for interrompida eh descartada */
+static void ai_iterate (AiWorker* w) {
+	AiSearch* s = &w->s;
+	const AiConfig* cfg = s->cfg;
+	AiResult* result = &w->result;
+
+	result->best_move = w->moves[0];
+	result->score = 0;
+	result->depth = 0;
+	result->pv_len = 0;
+
+	for ( int i = 0; i < w->count; i++ )
+		w->scores[i] = 0;
+
+	int prev_score = 0;
+
+	for ( int depth = w->start_depth; depth <= cfg->max_depth; depth++ ) {
+		int idx = 0;
+		int score = 0;
+
+		/* janela de aspiracao: em PVS, a partir da segunda iteracao, a raiz
+		   comeca numa janela estreita em volta do valor anterior e so
+		   alarga o lado que falhar */
+		int delta = AI_ASPIRATION_WINDOW;
+		int aspirate = cfg->algorithm == AI_ALGO_PVS && result->depth > 0;
+		int alpha = aspirate ? prev_score - delta : AI_LOSE_SCORE;
+		int beta = aspirate ? prev_score + delta : AI_WIN_SCORE;
+
+		while ( 1 ) {
+			if ( alpha < AI_LOSE_SCORE )
+				alpha = AI_LOSE_SCORE;
+			if ( beta > AI_WIN_SCORE )
+				beta = AI_WIN_SCORE;
+
+			ai_search_root (&w->work, w->moves, w->scores, w->count, depth, alpha, beta, w->maximizing_root, s, &idx, &score);
+			if ( s->stopped )
+				break;
+
+			if ( score <= alpha && alpha > AI_LOSE_SCORE ) {
+				delta *= 2;
+				alpha = score - delta;
+			} else if ( score >= beta && beta < AI_WIN_SCORE ) {
+				delta *= 2;
+				beta = score + delta;
+			} else {
+				break;
 			}
 		}
+
+		if ( s->stopped )
+			break;
+
+		prev_score = score;
+
+		result->best_move = w->moves[idx];
+		result->score = score;
+		result->depth = depth;
+		result->pv_len = s->pv_len[0];
+		for ( int k = 0; k < s->pv_len[0]; k++ )
+			result->pv[k] = s->pv[0][k];
+
+		/* proxima iteracao: melhor lance primeiro, depois os demais pelo
+		   valor obtido agora (insercao estavel) */
+		ai_sort_root (w->moves, w->scores, w->count, idx, w->maximizing_root);
+
+		s->can_stop = 1;
+
+		/* a proxima iteracao custa bem mais que esta: nem comeca se ja
+		   foi gasta metade do tempo */
+		if ( s->deadline_ms && (ai_now_ms () - s->start_ms) * 2 >= cfg->time_ms )
+			break;
+	}
+
+	result->nodes = s->nodes;
+}
+
+static void* ai_helper_main (void* arg) {
+	ai_iterate ((AiWorker*)arg);
+	return NULL;
+}
+
+/* thread do pool YBW: rouba tarefas ate o fim da busca */
+static void* ai_pool_main (void* arg) {
+	AiWorker* w = arg;
+	AiSearch* s = &w->s;
+
+	while ( !atomic_load_explicit (s->abort, memory_order_relaxed) ) {
+		AiTask task;
+		if ( ai_pool_take (s->pool, s->thread_id, NULL, &task) )
+			ai_ybw_run (s, task);
+		else
+			sched_yield ();
+	}
+
+	w->result.nodes = s->nodes;
+	return NULL;
+}
+
+static AiPool* ai_pool_create (int nthreads) {
+	AiPool* pool = malloc (sizeof *pool);
+	if ( !pool )
+		return NULL;
+
+	pool->deques = malloc ((size_t)nthreads * sizeof *pool->deques);
+	if ( !pool->deques ) {
+		free (pool);
+		return NULL;
+	}
+
+	pool->nthreads = nthreads;
+	atomic_init (&pool->done, 0);
+	for ( int t = 0; t < nthreads; t++ ) {
+		pthread_mutex_init (&pool->deques[t].lock, NULL);
+		pool->deques[t].head = 0;
+		pool->deques[t].tail = 0;
+	}
+
+	return pool;
+}
+
+static void ai_pool_destroy (AiPool* pool) {
+	if ( !pool )
+		return;
+
+	for ( int t = 0; t < pool->nthreads; t++ )
+		pthread_mutex_destroy (&pool->deques[t].lock);
+	free (pool->deques);
+	free (pool);
+}
+
+int ai_search (const Game* game, const AiConfig* cfg, AiResult* result) {
+	if ( cfg->engine == AI_ENGINE_MCTS )
+		return mcts_search (game, cfg, result);
+
+	int nthreads = cfg->threads < 1 ? 1 : cfg->threads;
+	if ( nthreads > AI_MAX_THREADS )
+		nthreads = AI_MAX_THREADS;
+
+	AiWorker* workers = malloc ((size_t)nthreads * sizeof *workers);
+	if ( !workers ) {
+		fprintf (stderr, "ai_search: sem memoria para %d threads\n", nthreads);
+		return -6;
+	}
+
+	/* lances da raiz, com a tabela de estados da thread 0 */
+	Move* moves = workers[0].moves;
+	int count = 0;
+
+	if ( game_generate_moves (game, moves, AI_MAX_MOVES, &count, &workers[0].s.jumps) != 0 ) {
+		fprintf (stderr, "ai_search: game_generate_moves falhou\n");
+		free (workers);
+		return -2;
+	}
+
+	if ( count <= 0 ) {
+		/* sem movimentos possiveis */
+		free (workers);
+		return 1;
+	}
+
+	TransTable* tt;
+	if ( ai_tt_acquire (cfg, &tt) != 0 ) {
+		free (workers);
+		return -5;
+	}
+
+	/* Lazy SMP: todas as threads buscam a mesma raiz e se ajudam apenas
+	   pela tabela de transposicao. YBW: so a thread 0 busca a raiz e as
+	   outras roubam tarefas dos pontos de divisao. Nos dois casos a thread
+	   0 (esta) decide o lance e o prazo; quando ela termina, as ajudantes
+	   sao interrompidas */
+	atomic_int abort_flag = 0;
+	AiPool* pool = NULL;
+
+	if ( cfg->parallel == AI_PAR_YBW && nthreads > 1 ) {
+		pool = ai_pool_create (nthreads);
+		if ( !pool ) {
+			fprintf (stderr, "ai_search: sem memoria para o pool de %d threads\n", nthreads);
+			free (workers);
+			ai_tt_done (tt);
+			return -6;
+		}
+	}
+
+	for ( int t = 0; t < nthreads; t++ ) {
+		AiWorker* w = &workers[t];
+
+		ai_search_init (&w->s, cfg, tt);
+		w->work = *game; /* unica copia por thread */
+		w->count = count;
+		w->maximizing_root = (game->to_move == cfg->side) ? 1 : 0; /* IA maximiza */
+		w->start_depth = 1 + (t & 1);
+
+		if ( t > 0 )
+			memcpy (w->moves, moves, (size_t)count * sizeof moves[0]);
+
+		if ( t > 0 ) {
+			w->s.deadline_ms = 0;
+			w->s.abort = &abort_flag;
+		}
+
+		if ( pool ) {
+			w->s.pool = pool;
+			w->s.thread_id = t;
+			w->s.abort = &pool->done; /* a thread 0 tambem: ela avisa o prazo */
+		}
 	}
 
-	*best_move = moves[best_idx];
+	int started = 1;
+	for ( int t = 1; t < nthreads; t++ ) {
+		void* (*entry) (void*) = pool ? ai_pool_main : ai_helper_main;
+
+		if ( pthread_create (&workers[t].thread, NULL, entry, &workers[t]) != 0 ) {
+			fprintf (stderr, "ai_search: pthread_create falhou (thread %d)\n", t);
+			break;
+		}
+		started++;
+	}
+
+	ai_iterate (&workers[0]);
+
+	atomic_store (&abort_flag, 1);
+	if ( pool )
+		atomic_store (&pool->done, 1);
+	for ( int t = 1; t < started; t++ )
+		pthread_join (workers[t].thread, NULL);
+
+	*result = workers[0].result;
+	for ( int t = 1; t < started; t++ )
+		result->nodes += workers[t].result.nodes;
+
+	ai_pool_destroy (pool);
+	free (workers);
+	ai_tt_done (tt);
+	return 0;
+}
+
+int ai_choose_move (const Game* game, const AiConfig* cfg, Move* best_move) {
+	AiResult result;
+
+	int err = ai_search (game, cfg, &result);
+	if ( err != 0 )
+		return err;
+
+	*best_move = result.best_move;
 	return 0;
 }
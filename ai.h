@@ -2,19 +2,108 @@
 #define AI_H
 
 #include "game.h"
+#include "tb.h"
 
-#define AI_MAX_MOVES 128
+#define AI_MAX_MOVES GAME_MAX_MOVES
 #define AI_WIN_SCORE 10000
 #define AI_LOSE_SCORE -10000
 
+/* vitoria a d meias jogadas da raiz vale AI_WIN_SCORE - d (derrota,
+   AI_LOSE_SCORE + d), seja o fim achado na busca ou na tabela de finais;
+   so valores a menos de AI_WIN_RANGE dos extremos sao vitorias forcadas */
+#define AI_WIN_RANGE 1000
+
+#define AI_DEFAULT_TT_MB 16 /* tamanho padrao da tabela de transposicao */
+#define AI_MAX_DEPTH 64		/* teto de profundidade quando so o tempo limita */
+#define AI_ASPIRATION_WINDOW 50 /* meia largura inicial da janela de aspiracao */
+#define AI_MAX_THREADS 64		/* teto para AiConfig.threads */
+#define AI_DEFAULT_MCTS_MB 64	/* pool de nos do MCTS */
+
+/**
+ * @brief O que a busca de quiescencia estende alem da profundidade nominal.
+ */
+typedef enum {
+	AI_QS_OFF = 0,	 /* avalia direto na profundidade 0                 */
+	AI_QS_CAPTURES,	 /* capturas da onca                                */
+	AI_QS_BLOCKS	 /* capturas + caes que bloqueiam um salto iminente */
+} AiQuiescence;
+
+/**
+ * @brief Algoritmo de busca usado por ai_alphabeta/ai_choose_move.
+ */
+typedef enum {
+	AI_ALGO_ALPHABETA = 0, /* alfa-beta com janela cheia em todo filho      */
+	AI_ALGO_PVS			   /* principal variation search + aspiracao na raiz */
+} AiAlgorithm;
+
+/**
+ * @brief Como as threads de ai_search dividem o trabalho (cfg->threads > 1).
+ */
+typedef enum {
+	AI_PAR_LAZY_SMP = 0, /* todas buscam a raiz e dividem so a tabela          */
+	AI_PAR_YBW			 /* Young Brothers Wait: irmaos viram tarefas roubaveis */
+} AiParallel;
+
+/**
+ * @brief Motor de busca usado por ai_search.
+ */
+typedef enum {
+	AI_ENGINE_ALPHABETA = 0, /* aprofundamento iterativo com alfa-beta/PVS */
+	AI_ENGINE_MCTS			 /* Monte Carlo Tree Search (mcts.h)          */
+} AiEngine;
+
+/**
+ * @brief Como o MCTS escolhe os lances dos playouts.
+ */
+typedef enum {
+	AI_PLAYOUT_RANDOM = 0, /* lance uniforme entre os legais                      */
+	AI_PLAYOUT_HEURISTIC   /* onca captura o maximo, caes evitam deixar captura */
+} AiPlayout;
+
 /**
  * @brief Configuracao da IA.
  */
 typedef struct {
 	int max_depth;	  /* profundidade maxima da busca */
 	CellContent side; /* lado para o qual avaliamos */
+	int tt_mb;		  /* MB da tabela de transposicao (0 = sem tabela) */
+	int time_ms;	  /* tempo por jogada em ms (0 = so max_depth) */
+
+	AiAlgorithm algorithm;	 /* AI_ALGO_PVS por padrao */
+	AiQuiescence quiescence; /* AI_QS_BLOCKS por padrao */
+
+	/* podas seletivas (1 = ligada), separadas para medir cada uma */
+	int null_move; /* poda por lance nulo                         */
+	int lmr;	   /* reducao de lances simples tardios (LMR)     */
+	int futility;  /* poda de futilidade perto das folhas         */
+
+	int threads;		 /* threads de busca, 1 = so a chamadora */
+	AiParallel parallel; /* AI_PAR_LAZY_SMP por padrao */
+
+	const TableBase* tablebase; /* tabela de finais consultada na busca, ou NULL */
+
+	AiEngine engine;   /* AI_ENGINE_ALPHABETA por padrao */
+	AiPlayout playout; /* MCTS: AI_PLAYOUT_HEURISTIC por padrao */
+	int mcts_mb;	   /* MCTS: MB do pool de nos */
+	int mcts_playouts; /* MCTS: playouts por busca (0 = so o tempo) */
 } AiConfig;
 
+/**
+ * @brief Preenche cfg com os valores padrao.
+ *
+ * Quem usa a IA deve chamar isto antes de ajustar os campos que quiser,
+ * para que campos novos tenham sempre um valor valido.
+ */
+void ai_config_default (AiConfig* cfg);
+
+/**
+ * @brief Libera a memoria mantida entre buscas (tabela de transposicao e
+ * pool de nos do MCTS).
+ *
+ * Nao faz nada se houver uma busca em andamento.
+ */
+void ai_release (void);
+
 /**
  * @brief Funcao de estimativa de recompensa (avaliacao heuristica).
  *
@@ -39,6 +128,13 @@ int ai_minimax (const Game* game, int depth, int maximizing, const AiConfig* cfg
 /**
  * @brief Busca adversaria com algoritmo MINIMAX e poda alfa-beta.
  *
+ * Consulta e alimenta a tabela de transposicao (cfg->tt_mb), que fica
+ * entre uma chamada e outra. Posicoes cobertas por cfg->tablebase nao
+ * sao buscadas: o valor exato vem da tabela, na mesma escala dos finais
+ * achados na busca (AI_WIN_SCORE menos as meias jogadas ate o fim, ver
+ * AI_WIN_RANGE). Supoe, como ai_choose_move, que maximizing eh 1
+ * exatamente quando game->to_move == cfg->side.
+ *
  * @param game Estado atual (nao modificado).
  * @param depth Profundidade restante.
  * @param alpha Limite inferior (melhor valor garantido para max).
@@ -50,10 +146,58 @@ int ai_minimax (const Game* game, int depth, int maximizing, const AiConfig* cfg
  */
 int ai_alphabeta (const Game* game, int depth, int alpha, int beta, int maximizing, const AiConfig* cfg, int* out_score);
 
+/**
+ * @brief Resultado de ai_search.
+ */
+typedef struct {
+	Move best_move; /* melhor lance na raiz                          */
+	int score;		/* valor do ponto de vista de cfg->side          */
+	int depth;		/* ultima profundidade completa                  */
+
+	Move pv[AI_MAX_DEPTH]; /* variante principal, comecando em best_move */
+	int pv_len;
+
+	long long nodes; /* nos visitados por todas as threads (inclui a iteracao descartada) */
+} AiResult;
+
+/**
+ * @brief Busca completa na raiz para o lado em game->to_move.
+ *
+ * Aprofundamento iterativo: profundidades 1, 2, ... ate cfg->max_depth.
+ * Em cada iteracao a raiz compartilha a janela entre os lances (o melhor
+ * valor ate aqui poda os seguintes) e os lances sao reordenados pelos
+ * valores da iteracao anterior, com o melhor na frente. Com
+ * cfg->time_ms > 0 a busca para no prazo e devolve o resultado da ultima
+ * profundidade completa (a primeira sempre completa).
+ *
+ * Com cfg->threads > 1 roda em Lazy SMP: threads ajudantes buscam a mesma
+ * raiz (comecando em profundidades alternadas) e compartilham so a tabela
+ * de transposicao, sem trava; o lance vem da thread chamadora.
+ *
+ * Com cfg->parallel == AI_PAR_YBW as threads formam um pool que divide a
+ * propria arvore (Young Brothers Wait): em cada no com profundidade
+ * suficiente o filho mais velho eh buscado primeiro, sozinho, e os irmaos
+ * viram tarefas na fila da thread, de onde as outras roubam. Um corte
+ * num ponto de divisao interrompe as subarvores dos irmaos restantes.
+ *
+ * A busca eh reentrante: cada chamada tem seu proprio estado, e chamadas
+ * simultaneas dividem apenas a tabela.
+ *
+ * Com cfg->engine == AI_ENGINE_MCTS a busca eh a de mcts_search (mcts.h);
+ * max_depth, tt_mb, algorithm e as podas nao se aplicam, e
+ * AiResult.nodes conta playouts.
+ *
+ * @param game Estado atual (nao modificado).
+ * @param cfg Configuracao da IA.
+ * @param result Saida: melhor lance, valor, profundidade e variante principal.
+ * @return 0 em sucesso, >0 se nao ha movimentos, <0 em erro.
+ */
+int ai_search (const Game* game, const AiConfig* cfg, AiResult* result);
+
 /**
  * @brief Escolhe a melhor acao para o lado em game->to_move.
  *
- * Internamente pode usar ai_alphabeta (ou ai_minimax) para decidir.
+ * Atalho para ai_search quando so o lance interessa.
  *
  * @param game Estado atual (nao modificado).
  * @param cfg Configuracao da IA.
@@ -1,3 +1,5 @@
+#define _POSIX_C_SOURCE 200809L // getopt
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -5,7 +7,9 @@
 #include <hiredis/hiredis.h>
 
 #include "ai.h"
+#include "book.h"
 #include "game.h"
+#include "mcts.h"
 
 #define REDIS_IP "127.0.0.1"
 #define REDIS_PORT 10001
@@ -148,22 +152,115 @@ static int send_move(redisContext* c, char side, const char* move_str) {
     freeReplyObject(reply);
     return 0;
 }
+/**
+ * @brief Mostra profundidade, valor, nos e a variante principal da busca.
+ * @param game Estado antes da jogada.
+ * @param r Resultado de ai_search.
+ */
+static void print_search_info(const Game* game, const AiResult* r) {
+    Game g = *game;
+
+    printf("  prof %d, valor %d, %lld nos, pv:", r->depth, r->score, r->nodes);
+    for (int i = 0; i < r->pv_len; i++) {
+        char buf[MAX_BUFFER_SIZE];
+        if (game_move_to_controller(&g, r->pv[i], buf, (int)sizeof buf) != 0)
+            break;
+        printf(" [%s]", buf);
+        game_apply_move(&g, r->pv[i]);
+    }
+    printf("\n");
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Uso: %s [-t ms] [-j threads] [-p smp|ybw] [-e ab|mcts] [-r] [-b tabela] [-l livro] <lado_ia> [profundidade]\n", prog);
+    fprintf(stderr, "  -t ms       tempo por jogada em milissegundos (aprofundamento iterativo;\n");
+    fprintf(stderr, "              sem profundidade explicita, busca ate onde o tempo deixar)\n");
+    fprintf(stderr, "  -j threads  threads de busca (padrao 1, max %d)\n", AI_MAX_THREADS);
+    fprintf(stderr, "  -p modo     divisao entre as threads: smp (Lazy SMP, padrao) ou ybw\n");
+    fprintf(stderr, "  -e motor    ab (alfa-beta, padrao) ou mcts (Monte Carlo; sem -t, %d playouts)\n", MCTS_DEFAULT_PLAYOUTS);
+    fprintf(stderr, "  -r          mcts com playouts aleatorios (padrao: heuristicos)\n");
+    fprintf(stderr, "  -b arquivo  tabela de finais gerada pelo tb_gen\n");
+    fprintf(stderr, "  -l arquivo  livro de aberturas gerado pelo book_gen\n");
+    fprintf(stderr, "Ex: %s o 5\n", prog);
+    fprintf(stderr, "    %s -t 2000 c\n", prog);
+}
+
 int main (int argc, char **argv) {
-    if (argc < 2) {
-        fprintf(stderr, "Uso: %s <lado_ia> [profundidade]\n", argv[0]);
-        fprintf(stderr, "Ex: %s o 5\n", argv[0]);
+    int time_ms = 0;
+    int threads = 1;
+    AiParallel parallel = AI_PAR_LAZY_SMP;
+    AiEngine engine = AI_ENGINE_ALPHABETA;
+    AiPlayout playout = AI_PLAYOUT_HEURISTIC;
+    const char* tb_path = NULL;
+    const char* book_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:j:p:e:rb:l:")) != -1) {
+        switch (opt) {
+        case 't':
+            time_ms = atoi(optarg);
+            if (time_ms < 1) {
+                fprintf(stderr, "Tempo inválido: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'j':
+            threads = atoi(optarg);
+            if (threads < 1 || threads > AI_MAX_THREADS) {
+                fprintf(stderr, "Numero de threads inválido: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'p':
+            if (strcmp(optarg, "smp") == 0) {
+                parallel = AI_PAR_LAZY_SMP;
+            } else if (strcmp(optarg, "ybw") == 0) {
+                parallel = AI_PAR_YBW;
+            } else {
+                fprintf(stderr, "Modo paralelo inválido: %s (use smp ou ybw)\n", optarg);
+                return 1;
+            }
+            break;
+        case 'e':
+            if (strcmp(optarg, "ab") == 0) {
+                engine = AI_ENGINE_ALPHABETA;
+            } else if (strcmp(optarg, "mcts") == 0) {
+                engine = AI_ENGINE_MCTS;
+            } else {
+                fprintf(stderr, "Motor inválido: %s (use ab ou mcts)\n", optarg);
+                return 1;
+            }
+            break;
+        case 'r':
+            playout = AI_PLAYOUT_RANDOM;
+            break;
+        case 'b':
+            tb_path = optarg;
+            break;
+        case 'l':
+            book_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
         return 1;
     }
 
-    char ia_side_char = argv[1][0];
+    char ia_side_char = argv[optind][0];
     if (ia_side_char != CTRL_JAGUAR_CHAR && ia_side_char != CTRL_DOG_CHAR) {
         fprintf(stderr, "Lado da IA inválido. Use '%c' (onça) ou '%c' (cão).\n", CTRL_JAGUAR_CHAR, CTRL_DOG_CHAR);
         return 1;
     }
 
-    int depth = AI_DEFAULT_DEPTH;
-    if (argc >= 3) {
-        depth = atoi(argv[2]);
+    // Com tempo e sem profundidade, quem limita a busca e o relogio
+    int depth = time_ms > 0 ? AI_MAX_DEPTH : AI_DEFAULT_DEPTH;
+    if (optind + 1 < argc) {
+        depth = atoi(argv[optind + 1]);
         if (depth < 1) {
             fprintf(stderr, "Profundidade inválida. Usando a default: %d.\n", AI_DEFAULT_DEPTH);
             depth = AI_DEFAULT_DEPTH;
@@ -175,7 +272,34 @@ int main (int argc, char **argv) {
 
     Game game;
     AiConfig ai_cfg;
+    ai_config_default(&ai_cfg);
     ai_cfg.max_depth = depth;
+    ai_cfg.time_ms = time_ms;
+    ai_cfg.threads = threads;
+    ai_cfg.parallel = parallel;
+    ai_cfg.engine = engine;
+    ai_cfg.playout = playout;
+
+    // Tabela de finais: carregada uma vez, consultada em toda busca
+    TableBase tablebase;
+    if (tb_path) {
+        if (tb_load(&tablebase, tb_path) != 0) {
+            fprintf(stderr, "Falha ao carregar a tabela de finais %s.\n", tb_path);
+            return 1;
+        }
+        ai_cfg.tablebase = &tablebase;
+        printf("Tabela de finais: %d a %d cães.\n", tablebase.min_dogs, tablebase.max_dogs);
+    }
+
+    // Livro de aberturas: mapeado direto do arquivo, sem copiar
+    Book book;
+    if (book_path) {
+        if (book_open(&book, book_path) != 0) {
+            fprintf(stderr, "Falha ao abrir o livro de aberturas %s.\n", book_path);
+            return 1;
+        }
+        printf("Livro de aberturas: %zu posições.\n", book.count);
+    }
     ai_cfg.side = (ia_side_char == CTRL_JAGUAR_CHAR) ? CELL_JAGUAR : CELL_DOG;
 
     if (game_init(&game) != 0) {
@@ -186,7 +310,9 @@ int main (int argc, char **argv) {
     redisContext* c = connect_redis();
     if (!c) return 1;
 
-    printf("AI Player (Lado: %c, Profundidade: %d) conectado. Aguardando a vez...\n", ia_side_char, depth);
+    printf("AI Player (Lado: %c, Profundidade: %d, Tempo: %d ms, Threads: %d %s, Motor: %s) conectado. Aguardando a vez...\n",
+           ia_side_char, depth, time_ms, threads, parallel == AI_PAR_YBW ? "ybw" : "smp",
+           engine == AI_ENGINE_MCTS ? (playout == AI_PLAYOUT_RANDOM ? "mcts aleatório" : "mcts") : "alfa-beta");
 
     // Loop principal: Aguardar a vez, calcular e enviar a jogada
     while (1) {
@@ -227,9 +353,23 @@ int main (int argc, char **argv) {
             break;
         }
 
-        // Calcular a melhor jogada
-        Move best_move;
-        int ar = ai_choose_move(&game, &ai_cfg, &best_move);
+        // Calcular a melhor jogada (posição do livro sai na hora, sem busca)
+        AiResult result;
+        BookEntry book_entry;
+        int ar;
+        if (book_path && book_probe(&book, &game, &book_entry)) {
+            memset(&result, 0, sizeof result);
+            result.best_move = book_entry.move;
+            result.score = book_entry.score;
+            result.depth = book_entry.depth;
+            result.pv[0] = book_entry.move;
+            result.pv_len = 1;
+            ar = 0;
+            printf("Jogada do livro de aberturas.\n");
+        } else {
+            ar = ai_search(&game, &ai_cfg, &result);
+        }
+        Move best_move = result.best_move;
 
         char move_buffer[MAX_BUFFER_SIZE];
         if (ar != 0) {
@@ -238,18 +378,20 @@ int main (int argc, char **argv) {
                 printf("Agente (%c) não encontrou movimentos legais. Enviando jogada nula.\n", ia_side_char);
                 sprintf(move_buffer, "%c n", ia_side_char);
             } else {
-                fprintf(stderr, "Erro na função ai_choose_move (err=%d).\n", ar);
+                fprintf(stderr, "Erro na função ai_search (err=%d).\n", ar);
                 sprintf(move_buffer, "%c n", ia_side_char); // Envia nulo para não bloquear
             }
         } else {
             //Formatar a jogada para o controlador
-            if (game_move_to_controller(&game, &best_move, move_buffer, (int)sizeof move_buffer) != 0) {
+            if (game_move_to_controller(&game, best_move, move_buffer, (int)sizeof move_buffer) != 0) {
                 fprintf(stderr, "Falha ao formatar a jogada para o controlador.\n");
                 sprintf(move_buffer, "%c n", ia_side_char);
             }
         }
 
         printf("Agente (%c) jogada calculada: %s\n", ia_side_char, move_buffer);
+        if (ar == 0)
+            print_search_info(&game, &result);
 
         // Enviar a jogada para o Redis
         if (send_move(c, ia_side_char, move_buffer) != 0) {
@@ -259,5 +401,10 @@ int main (int argc, char **argv) {
     }
 
     redisFree(c);
+    ai_release();
+    if (tb_path)
+        tb_destroy(&tablebase);
+    if (book_path)
+        book_close(&book);
     return 0;
 }
\ No newline at end of file
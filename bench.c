@@ -0,0 +1,323 @@
+#define _POSIX_C_SOURCE 200809L /* clock_gettime */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ai.h"
+#include "game.h"
+#include "rank.h"
+
+/* posicoes fixas (formato do controlador) e lado que joga em cada uma */
+typedef struct {
+	const char* board;
+	char lado;
+} BenchPosition;
+
+static const BenchPosition bench_positions[] = {
+	{ "#######\n#ccccc#\n#ccccc#\n#ccocc#\n#-----#\n#-----#\n# --- #\n#- - -#\n#######\n", CTRL_JAGUAR_CHAR },
+	{ "#######\n#cc-cc#\n#c-ccc#\n#-c-c-#\n#-co--#\n#-c---#\n# --- #\n#- - -#\n#######\n", CTRL_DOG_CHAR },
+	{ "#######\n#c-c-c#\n#cc-cc#\n#-ccc-#\n#c-o-c#\n#--c--#\n# --- #\n#- - -#\n#######\n", CTRL_DOG_CHAR },
+	{ "#######\n#c-c-c#\n#cc-cc#\n#-ccc-#\n#c-o-c#\n#--c--#\n# --- #\n#- - -#\n#######\n", CTRL_JAGUAR_CHAR },
+};
+
+#define BENCH_NUM_POSITIONS ((int)(sizeof bench_positions / sizeof bench_positions[0]))
+
+static double bench_now (void) {
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* busca todas as posicoes com cfg; devolve tempo e nos somados */
+static int bench_search_all (const AiConfig* base, double* out_time, long long* out_nodes) {
+	Game game;
+
+	*out_time = 0.0;
+	*out_nodes = 0;
+
+	for ( int i = 0; i < BENCH_NUM_POSITIONS; i++ ) {
+		if ( game_init (&game) != 0 ||
+			 game_from_controller_board (&game, bench_positions[i].board, bench_positions[i].lado) != 0 ) {
+			fprintf (stderr, "bench: posicao %d invalida\n", i);
+			return -1;
+		}
+
+		AiConfig cfg = *base;
+		cfg.side = game.to_move;
+
+		/* tabela (e arvore do MCTS) vazia em toda busca: uma medida nao
+		   aquece a seguinte */
+		ai_release ();
+
+		AiResult result;
+		double t0 = bench_now ();
+		int err = ai_search (&game, &cfg, &result);
+		double t1 = bench_now ();
+
+		if ( err != 0 ) {
+			fprintf (stderr, "bench: ai_search falhou na posicao %d (err=%d)\n", i, err);
+			return -2;
+		}
+
+		*out_time += t1 - t0;
+		*out_nodes += result.nodes;
+	}
+
+	return 0;
+}
+
+/* escalabilidade da busca paralela: mesmas posicoes com 1..N threads */
+static int bench_search (int argc, char** argv) {
+	int max_threads = argc > 0 ? atoi (argv[0]) : 4;
+	int depth = argc > 1 ? atoi (argv[1]) : 9;
+	AiParallel parallel = AI_PAR_YBW;
+
+	if ( argc > 2 ) {
+		if ( strcmp (argv[2], "smp") == 0 ) {
+			parallel = AI_PAR_LAZY_SMP;
+		} else if ( strcmp (argv[2], "ybw") != 0 ) {
+			fprintf (stderr, "bench search: modo invalido: %s (use smp ou ybw)\n", argv[2]);
+			return 1;
+		}
+	}
+
+	if ( max_threads < 1 || max_threads > AI_MAX_THREADS || depth < 1 || depth > AI_MAX_DEPTH ) {
+		fprintf (stderr, "bench search: parametros invalidos\n");
+		return 1;
+	}
+
+	AiConfig cfg;
+	ai_config_default (&cfg);
+	cfg.max_depth = depth;
+	cfg.parallel = parallel;
+
+	printf ("busca %s, profundidade %d, %d posicoes\n", parallel == AI_PAR_YBW ? "ybw" : "smp", depth,
+			BENCH_NUM_POSITIONS);
+	printf ("%7s %10s %12s %12s %8s\n", "threads", "tempo(s)", "nos", "nos/s", "speedup");
+
+	double base_time = 0.0;
+
+	for ( int t = 1; t <= max_threads; t++ ) {
+		double time;
+		long long nodes;
+
+		cfg.threads = t;
+		if ( bench_search_all (&cfg, &time, &nodes) != 0 )
+			return 1;
+
+		if ( t == 1 )
+			base_time = time;
+
+		printf ("%7d %10.3f %12lld %12.0f %8.2f\n", t, time, nodes, time > 0 ? nodes / time : 0.0,
+				time > 0 ? base_time / time : 0.0);
+	}
+
+	ai_release ();
+	return 0;
+}
+
+/* PVS contra alfa-beta de janela cheia: nos e tempo por profundidade,
+   com uma thread (a contagem de nos nao depende do escalonamento) */
+static int bench_pvs (int argc, char** argv) {
+	int max_depth = argc > 0 ? atoi (argv[0]) : 9;
+
+	if ( max_depth < 1 || max_depth > AI_MAX_DEPTH ) {
+		fprintf (stderr, "bench pvs: parametros invalidos\n");
+		return 1;
+	}
+
+	AiConfig cfg;
+	ai_config_default (&cfg);
+	cfg.threads = 1;
+
+	printf ("pvs x alfa-beta, profundidade 1 a %d, %d posicoes\n", max_depth, BENCH_NUM_POSITIONS);
+	printf ("%5s %12s %10s %12s %10s %8s %8s\n", "prof", "nos ab", "tempo ab", "nos pvs", "tempo pvs", "nos", "tempo");
+
+	for ( int depth = 1; depth <= max_depth; depth++ ) {
+		double ab_time, pvs_time;
+		long long ab_nodes, pvs_nodes;
+
+		cfg.max_depth = depth;
+
+		cfg.algorithm = AI_ALGO_ALPHABETA;
+		if ( bench_search_all (&cfg, &ab_time, &ab_nodes) != 0 )
+			return 1;
+
+		cfg.algorithm = AI_ALGO_PVS;
+		if ( bench_search_all (&cfg, &pvs_time, &pvs_nodes) != 0 )
+			return 1;
+
+		/* ultimas colunas: pvs em relacao a alfa-beta */
+		printf ("%5d %12lld %10.3f %12lld %10.3f %8.2f %8.2f\n", depth, ab_nodes, ab_time, pvs_nodes, pvs_time,
+				ab_nodes > 0 ? (double)pvs_nodes / ab_nodes : 0.0, ab_time > 0 ? pvs_time / ab_time : 0.0);
+	}
+
+	ai_release ();
+	return 0;
+}
+
+/* playouts por segundo do MCTS com 1..N threads, ms em cada posicao */
+static int bench_mcts (int argc, char** argv) {
+	int max_threads = argc > 0 ? atoi (argv[0]) : 4;
+	int time_ms = argc > 1 ? atoi (argv[1]) : 1000;
+	AiPlayout playout = AI_PLAYOUT_HEURISTIC;
+
+	if ( argc > 2 ) {
+		if ( strcmp (argv[2], "random") == 0 ) {
+			playout = AI_PLAYOUT_RANDOM;
+		} else if ( strcmp (argv[2], "heuristic") != 0 ) {
+			fprintf (stderr, "bench mcts: playout invalido: %s (use random ou heuristic)\n", argv[2]);
+			return 1;
+		}
+	}
+
+	if ( max_threads < 1 || max_threads > AI_MAX_THREADS || time_ms < 1 ) {
+		fprintf (stderr, "bench mcts: parametros invalidos\n");
+		return 1;
+	}
+
+	AiConfig cfg;
+	ai_config_default (&cfg);
+	cfg.engine = AI_ENGINE_MCTS;
+	cfg.playout = playout;
+	cfg.time_ms = time_ms;
+
+	printf ("mcts, playouts %s, %d ms por posicao, %d posicoes\n", playout == AI_PLAYOUT_RANDOM ? "random" : "heuristic",
+			time_ms, BENCH_NUM_POSITIONS);
+	printf ("%7s %10s %12s %12s %8s\n", "threads", "tempo(s)", "playouts", "playouts/s", "speedup");
+
+	double base_rate = 0.0;
+
+	for ( int t = 1; t <= max_threads; t++ ) {
+		double time;
+		long long playouts;
+
+		cfg.threads = t;
+		if ( bench_search_all (&cfg, &time, &playouts) != 0 )
+			return 1;
+
+		double rate = time > 0 ? playouts / time : 0.0;
+		if ( t == 1 )
+			base_rate = rate;
+
+		printf ("%7d %10.3f %12lld %12.0f %8.2f\n", t, time, playouts, rate, base_rate > 0 ? rate / base_rate : 0.0);
+	}
+
+	ai_release ();
+	return 0;
+}
+
+/* xorshift64: posicoes pseudo-aleatorias reprodutiveis */
+static uint64_t bench_random (uint64_t* state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+/* rank/unrank: ida e volta em posicoes aleatorias com k caes, e a
+   bijecao completa numa camada pequena */
+static int bench_rank (int argc, char** argv) {
+	int k = argc > 0 ? atoi (argv[0]) : 10;
+	int count = argc > 1 ? atoi (argv[1]) : 1000000;
+	Game base;
+
+	if ( game_init (&base) != 0 )
+		return 1;
+
+	int n = base.g->num_vertices;
+	if ( k < 0 || k > n - 1 || count < 1 ) {
+		fprintf (stderr, "bench rank: parametros invalidos (caes de 0 a %d)\n", n - 1);
+		return 1;
+	}
+
+	Game* games = malloc ((size_t)count * sizeof *games);
+	uint64_t* index = malloc ((size_t)count * sizeof *index);
+	if ( !games || !index ) {
+		fprintf (stderr, "bench rank: sem memoria para %d posicoes\n", count);
+		free (games);
+		free (index);
+		return 1;
+	}
+
+	uint64_t seed = 0x2545F4914F6CDD1DULL;
+	for ( int i = 0; i < count; i++ ) {
+		Game* g = &games[i];
+		*g = base;
+		g->jaguar_pos = (int)(bench_random (&seed) % (uint64_t)n);
+		g->to_move = (bench_random (&seed) & 1) ? CELL_JAGUAR : CELL_DOG;
+		g->dogs = BB_EMPTY;
+		while ( bb_popcount (g->dogs) < k ) {
+			int v = (int)(bench_random (&seed) % (uint64_t)n);
+			if ( v != g->jaguar_pos )
+				g->dogs |= BB_BIT (v);
+		}
+	}
+
+	uint64_t sum = 0; /* impede que o compilador descarte os lacos */
+	double t0 = bench_now ();
+	for ( int i = 0; i < count; i++ )
+		sum += rank_position (&games[i]);
+	double t1 = bench_now ();
+	rank_positions (games, count, index);
+	double t2 = bench_now ();
+
+	int errors = 0;
+	Game back = base;
+	for ( int i = 0; i < count; i++ ) {
+		rank_position_unrank (&back, k, index[i]);
+		if ( back.dogs != games[i].dogs || back.jaguar_pos != games[i].jaguar_pos ||
+			 back.to_move != games[i].to_move )
+			errors++;
+	}
+	double t3 = bench_now ();
+
+	/* bijecao: toda posicao da camada de 2 caes volta ao proprio indice */
+	uint64_t size = rank_layer_size (n, 2);
+	for ( uint64_t i = 0; i < size; i++ ) {
+		rank_position_unrank (&back, 2, i);
+		if ( rank_position (&back) != i || bb_test (back.dogs, back.jaguar_pos) )
+			errors++;
+	}
+
+	printf ("rank: %d posicoes com %d caes (camada de %llu indices)\n", count, k,
+			(unsigned long long)rank_layer_size (n, k));
+	printf ("  rank_position        %8.1f ns/posicao\n", (t1 - t0) * 1e9 / count);
+	printf ("  rank_positions       %8.1f ns/posicao\n", (t2 - t1) * 1e9 / count);
+	printf ("  rank_position_unrank %8.1f ns/posicao\n", (t3 - t2) * 1e9 / count);
+	printf ("  erros %d (soma %llu)\n", errors, (unsigned long long)(sum & 0xffff));
+
+	free (games);
+	free (index);
+	return errors ? 1 : 0;
+}
+
+static void usage (const char* prog) {
+	fprintf (stderr, "Uso: %s <teste> [parametros]\n", prog);
+	fprintf (stderr, "  search [threads] [profundidade] [smp|ybw]  escalabilidade de 1 a N threads\n");
+	fprintf (stderr, "  pvs [profundidade]                         nos e tempo de PVS x alfa-beta\n");
+	fprintf (stderr, "  mcts [threads] [ms] [random|heuristic]     playouts/s do MCTS de 1 a N threads\n");
+	fprintf (stderr, "  rank [caes] [posicoes]                     rank/unrank de posicoes\n");
+}
+
+int main (int argc, char** argv) {
+	if ( argc < 2 ) {
+		usage (argv[0]);
+		return 1;
+	}
+
+	if ( strcmp (argv[1], "search") == 0 )
+		return bench_search (argc - 2, argv + 2);
+	if ( strcmp (argv[1], "pvs") == 0 )
+		return bench_pvs (argc - 2, argv + 2);
+	if ( strcmp (argv[1], "mcts") == 0 )
+		return bench_mcts (argc - 2, argv + 2);
+	if ( strcmp (argv[1], "rank") == 0 )
+		return bench_rank (argc - 2, argv + 2);
+
+	usage (argv[0]);
+	return 1;
+}
@@ -0,0 +1,47 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+/**
+ * @brief Conjunto de vertices do grafo representado como mascara de bits.
+ *
+ * O bit v corresponde ao vertice v do grafo. Como GRAPH_MAX_VERTICES <= 64,
+ * qualquer subconjunto de vertices cabe em uma unica palavra de 64 bits.
+ */
+typedef uint64_t Bitboard;
+
+#define BB_EMPTY ((Bitboard)0)
+#define BB_BIT(v) ((Bitboard)1 << (v))
+
+/**
+ * @brief Numero de vertices presentes no conjunto.
+ */
+static inline int bb_popcount (Bitboard b) {
+	return __builtin_popcountll (b);
+}
+
+/**
+ * @brief Indice do menor vertice presente no conjunto (b != 0).
+ */
+static inline int bb_lsb (Bitboard b) {
+	return __builtin_ctzll (b);
+}
+
+/**
+ * @brief Remove e retorna o menor vertice presente no conjunto (*b != 0).
+ */
+static inline int bb_pop_lsb (Bitboard* b) {
+	int v = __builtin_ctzll (*b);
+	*b &= *b - 1;
+	return v;
+}
+
+/**
+ * @brief 1 se o vertice v pertence ao conjunto, 0 caso contrario.
+ */
+static inline int bb_test (Bitboard b, int v) {
+	return (int)((b >> v) & 1);
+}
+
+#endif /* BITBOARD_H */
@@ -0,0 +1,170 @@
+#define _POSIX_C_SOURCE 200809L /* mmap, fstat */
+
+#include "book.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* cabecalho do arquivo; as entradas vem logo depois, ordenadas por chave */
+typedef struct {
+	char magic[8];
+	uint32_t entry_size; /* sizeof (BookEntry) de quem gravou */
+	uint32_t reserved;
+	uint64_t count;
+	uint64_t graph_hash; /* vizinhancas e saltos: o mapa tem que ser o mesmo */
+} BookHeader;
+
+_Static_assert (sizeof (BookEntry) == 24, "BookEntry deve ter 24 bytes");
+
+int book_open (Book* book, const char* path) {
+	Game base;
+
+	if ( !book || !path || game_init (&base) != 0 ) {
+		fprintf (stderr, "book_open: parametros invalidos\n");
+		return -1;
+	}
+
+	memset (book, 0, sizeof *book);
+
+	int fd = open (path, O_RDONLY);
+	if ( fd < 0 ) {
+		fprintf (stderr, "book_open: nao foi possivel abrir %s\n", path);
+		return -2;
+	}
+
+	struct stat st;
+	if ( fstat (fd, &st) != 0 || (size_t)st.st_size < sizeof (BookHeader) ) {
+		fprintf (stderr, "book_open: %s vazio ou ilegivel\n", path);
+		close (fd);
+		return -3;
+	}
+
+	size_t bytes = (size_t)st.st_size;
+	void* map = mmap (NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd); /* o mapeamento continua valido */
+
+	if ( map == MAP_FAILED ) {
+		fprintf (stderr, "book_open: mmap falhou para %s\n", path);
+		return -4;
+	}
+
+	const BookHeader* h = map;
+	if ( memcmp (h->magic, BOOK_MAGIC, sizeof h->magic) != 0 || h->entry_size != sizeof (BookEntry) ||
+		 h->count != (bytes - sizeof *h) / sizeof (BookEntry) ) {
+		fprintf (stderr, "book_open: %s nao eh um livro de aberturas valido\n", path);
+		munmap (map, bytes);
+		return -5;
+	}
+
+	if ( h->graph_hash != graph_hash (base.g) ) {
+		fprintf (stderr, "book_open: %s foi gerado para outro tabuleiro\n", path);
+		munmap (map, bytes);
+		return -6;
+	}
+
+	book->map = map;
+	book->map_bytes = bytes;
+	book->entries = (const BookEntry*)((const char*)map + sizeof *h);
+	book->count = (size_t)h->count;
+	return 0;
+}
+
+void book_close (Book* book) {
+	if ( !book || !book->map )
+		return;
+
+	munmap (book->map, book->map_bytes);
+	memset (book, 0, sizeof *book);
+}
+
+int book_probe (const Book* book, const Game* game, BookEntry* out) {
+	if ( !book || !book->entries )
+		return 0;
+
+	/* entradas na forma canonica: a mesma para a posicao e o seu espelho */
+	int mirrored = game_mirror_needed (game);
+	uint64_t key = mirrored ? game->mirror_key : game->key;
+	size_t lo = 0;
+	size_t hi = book->count;
+
+	while ( lo < hi ) {
+		size_t mid = lo + (hi - lo) / 2;
+		if ( book->entries[mid].key < key )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if ( lo == book->count || book->entries[lo].key != key )
+		return 0;
+
+	Move mv = book->entries[lo].move;
+	if ( mirrored )
+		mv = game_mirror_move (game, mv);
+
+	if ( game_is_legal_move (game, mv) != 1 )
+		return 0; /* colisao de chave */
+
+	*out = book->entries[lo];
+	out->move = mv;
+	return 1;
+}
+
+/* por chave; na mesma chave, a mais profunda primeiro */
+static int book_entry_cmp (const void* a, const void* b) {
+	const BookEntry* x = a;
+	const BookEntry* y = b;
+
+	if ( x->key != y->key )
+		return x->key < y->key ? -1 : 1;
+	return (int)y->depth - (int)x->depth;
+}
+
+int book_write (const char* path, BookEntry entries[], size_t count) {
+	Game base;
+
+	if ( !path || (!entries && count > 0) || game_init (&base) != 0 ) {
+		fprintf (stderr, "book_write: parametros invalidos\n");
+		return -1;
+	}
+
+	qsort (entries, count, sizeof *entries, book_entry_cmp);
+
+	size_t unique = 0;
+	for ( size_t i = 0; i < count; i++ ) {
+		if ( unique > 0 && entries[unique - 1].key == entries[i].key )
+			continue;
+		entries[unique] = entries[i];
+		entries[unique].reserved = 0;
+		unique++;
+	}
+
+	FILE* f = fopen (path, "wb");
+	if ( !f ) {
+		fprintf (stderr, "book_write: nao foi possivel criar %s\n", path);
+		return -2;
+	}
+
+	BookHeader h;
+	memset (&h, 0, sizeof h);
+	memcpy (h.magic, BOOK_MAGIC, sizeof h.magic);
+	h.entry_size = sizeof (BookEntry);
+	h.count = unique;
+	h.graph_hash = graph_hash (base.g);
+
+	int ok = fwrite (&h, sizeof h, 1, f) == 1 && fwrite (entries, sizeof *entries, unique, f) == unique;
+	if ( fclose (f) != 0 )
+		ok = 0;
+
+	if ( !ok ) {
+		fprintf (stderr, "book_write: erro ao gravar %s\n", path);
+		return -3;
+	}
+
+	return 0;
+}
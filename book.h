@@ -0,0 +1,72 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+
+#define BOOK_MAGIC "ONCABK03" /* 8 bytes no inicio do arquivo */
+
+/**
+ * @brief Entrada do livro de aberturas (24 bytes, como fica no arquivo).
+ *
+ * O score eh do ponto de vista de quem joga na posicao, como na tabela
+ * de transposicao.
+ */
+typedef struct {
+	uint64_t key; /* chave Zobrist da forma canonica (game_canonical_key) */
+	Move move;	  /* melhor lance da busca offline, na forma canonica */
+	int32_t score;
+	int16_t depth;
+	uint16_t reserved; /* zero */
+} BookEntry;
+
+/**
+ * @brief Livro aberto com book_open: entradas ordenadas por chave,
+ * mapeadas direto do arquivo (somente leitura).
+ */
+typedef struct {
+	const BookEntry* entries;
+	size_t count;
+
+	void* map; /* regiao mapeada (cabecalho + entradas) */
+	size_t map_bytes;
+} Book;
+
+/**
+ * @brief Mapeia o arquivo path na memoria.
+ *
+ * Recusa livros gravados para outro tabuleiro (graph_hash diferente).
+ *
+ * @return 0 em sucesso, <0 em erro (arquivo ausente, truncado, de outro
+ *         formato ou de outro tabuleiro).
+ */
+int book_open (Book* book, const char* path);
+
+/**
+ * @brief Desfaz o mapeamento.
+ */
+void book_close (Book* book);
+
+/**
+ * @brief Procura a posicao de game (busca binaria pela chave).
+ *
+ * Posicao e espelho dividem a entrada; o lance devolvido ja vem
+ * orientado para game. So devolve a entrada se esse lance for legal, o
+ * que descarta colisoes de chave.
+ *
+ * @return 1 se encontrou, 0 caso contrario.
+ */
+int book_probe (const Book* book, const Game* game, BookEntry* out);
+
+/**
+ * @brief Grava count entradas em path, ordenadas por chave.
+ *
+ * entries eh reordenado; chaves repetidas ficam com a entrada mais profunda.
+ *
+ * @return 0 em sucesso, <0 em erro.
+ */
+int book_write (const char* path, BookEntry entries[], size_t count);
+
+#endif /* BOOK_H */
@@ -0,0 +1,214 @@
+#define _POSIX_C_SOURCE 200809L /* clock_gettime */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ai.h"
+#include "book.h"
+#include "game.h"
+
+/* gerador offline do livro de aberturas (book.h).
+ *
+ * Para cada lado, percorre a arvore a partir do tabuleiro inicial: onde
+ * esse lado joga, busca fundo e segue so o lance escolhido; onde joga o
+ * adversario, segue todos os lances. Toda posicao buscada vira entrada. */
+
+/* mesmo tabuleiro inicial do controlador.c */
+static const char tabuleiro_inicial[] =
+	"#######\n"
+	"#ccccc#\n"
+	"#ccccc#\n"
+	"#ccocc#\n"
+	"#-----#\n"
+	"#-----#\n"
+	"# --- #\n"
+	"#- - -#\n"
+	"#######\n";
+
+typedef struct {
+	AiConfig cfg;
+	int plies; /* profundidade da arvore de aberturas */
+
+	BookEntry* entries;
+	size_t count;
+	size_t capacity;
+
+	/* posicoes ja buscadas: indice + 1 em entries (enderecamento aberto, 0 = vazio) */
+	size_t* seen;
+	size_t seen_mask;
+
+	GameJumpTable jumps; /* estados das cadeias de saltos da expansao */
+} BookGen;
+
+static double book_gen_now (void) {
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* entrada ja buscada para key, ou NULL */
+static const BookEntry* book_gen_find (const BookGen* bg, uint64_t key) {
+	for ( size_t i = key & bg->seen_mask; bg->seen[i]; i = (i + 1) & bg->seen_mask ) {
+		if ( bg->entries[bg->seen[i] - 1].key == key )
+			return &bg->entries[bg->seen[i] - 1];
+	}
+	return NULL;
+}
+
+static int book_gen_add (BookGen* bg, const BookEntry* e) {
+	if ( bg->count * 2 >= bg->seen_mask ) {
+		fprintf (stderr, "book_gen: posicoes demais (max %zu)\n", bg->seen_mask / 2);
+		return -1;
+	}
+
+	if ( bg->count == bg->capacity ) {
+		size_t cap = bg->capacity ? bg->capacity * 2 : 256;
+		BookEntry* p = realloc (bg->entries, cap * sizeof *p);
+		if ( !p ) {
+			fprintf (stderr, "book_gen: sem memoria\n");
+			return -1;
+		}
+		bg->entries = p;
+		bg->capacity = cap;
+	}
+
+	bg->entries[bg->count++] = *e;
+
+	size_t i = e->key & bg->seen_mask;
+	while ( bg->seen[i] )
+		i = (i + 1) & bg->seen_mask;
+	bg->seen[i] = bg->count;
+	return 0;
+}
+
+/* busca fundo a posicao (ou reaproveita a busca anterior) */
+static int book_gen_search (BookGen* bg, const Game* game, BookEntry* out) {
+	/* o livro guarda a forma canonica (espelho); out volta orientado para game */
+	int mirrored = game_mirror_needed (game);
+	const BookEntry* known = book_gen_find (bg, game_canonical_key (game));
+	if ( known ) {
+		*out = *known;
+		if ( mirrored )
+			out->move = game_mirror_move (game, out->move);
+		return 0;
+	}
+
+	AiConfig cfg = bg->cfg;
+	cfg.side = game->to_move;
+
+	AiResult result;
+	int err = ai_search (game, &cfg, &result);
+	if ( err != 0 )
+		return err;
+
+	out->key = game_canonical_key (game);
+	out->move = mirrored ? game_mirror_move (game, result.best_move) : result.best_move;
+	out->score = result.score; /* cfg.side = quem joga */
+	out->depth = (int16_t)result.depth;
+	out->reserved = 0;
+
+	char buf[128];
+	if ( game_move_to_controller (game, result.best_move, buf, sizeof buf) != 0 )
+		buf[0] = '\0';
+	printf ("  %6zu  %-20s valor %6d  prof %2d\n", bg->count + 1, buf, result.score, result.depth);
+	fflush (stdout);
+
+	err = book_gen_add (bg, out);
+	out->move = result.best_move;
+	return err;
+}
+
+static int book_gen_expand (BookGen* bg, Game* game, CellContent side, int ply) {
+	if ( ply >= bg->plies || game->winner != CELL_EMPTY )
+		return 0;
+
+	if ( game->to_move == side ) {
+		BookEntry e;
+		int err = book_gen_search (bg, game, &e);
+		if ( err > 0 )
+			return 0; /* sem lances */
+		if ( err < 0 )
+			return err;
+
+		GameUndo undo;
+		if ( game_make_move (game, e.move, &undo) != 0 )
+			return -1;
+		err = book_gen_expand (bg, game, side, ply + 1);
+		game_unmake_move (game, e.move, &undo);
+		return err;
+	}
+
+	Move moves[GAME_MAX_MOVES];
+	int count = 0;
+	if ( game_generate_moves (game, moves, GAME_MAX_MOVES, &count, &bg->jumps) != 0 )
+		return -1;
+
+	for ( int i = 0; i < count; i++ ) {
+		GameUndo undo;
+		if ( game_make_move (game, moves[i], &undo) != 0 )
+			continue;
+
+		int err = book_gen_expand (bg, game, side, ply + 1);
+		game_unmake_move (game, moves[i], &undo);
+		if ( err != 0 )
+			return err;
+	}
+
+	return 0;
+}
+
+int main (int argc, char** argv) {
+	if ( argc < 2 ) {
+		fprintf (stderr, "Uso: %s <arquivo> [lances] [profundidade] [threads]\n", argv[0]);
+		fprintf (stderr, "  lances: meias jogadas da arvore de aberturas (padrao 6)\n");
+		fprintf (stderr, "  profundidade: busca em cada posicao do livro (padrao 12)\n");
+		return 1;
+	}
+
+	BookGen bg = { 0 };
+	ai_config_default (&bg.cfg);
+	bg.plies = argc > 2 ? atoi (argv[2]) : 6;
+	bg.cfg.max_depth = argc > 3 ? atoi (argv[3]) : 12;
+	bg.cfg.threads = argc > 4 ? atoi (argv[4]) : 1;
+	bg.cfg.tt_mb = 256;
+
+	if ( bg.plies < 1 || bg.cfg.max_depth < 1 || bg.cfg.max_depth > AI_MAX_DEPTH || bg.cfg.threads < 1 ) {
+		fprintf (stderr, "book_gen: parametros invalidos\n");
+		return 1;
+	}
+
+	bg.seen_mask = (1u << 20) - 1;
+	bg.seen = calloc (bg.seen_mask + 1, sizeof *bg.seen);
+	if ( !bg.seen ) {
+		fprintf (stderr, "book_gen: sem memoria\n");
+		return 1;
+	}
+
+	Game game;
+	if ( game_init (&game) != 0 ||
+		 game_from_controller_board (&game, tabuleiro_inicial, CTRL_JAGUAR_CHAR) != 0 ) {
+		fprintf (stderr, "book_gen: tabuleiro inicial invalido\n");
+		return 1;
+	}
+
+	double t0 = book_gen_now ();
+	int err = 0;
+	const CellContent sides[2] = { CELL_JAGUAR, CELL_DOG };
+
+	for ( int s = 0; s < 2 && err == 0; s++ ) {
+		printf ("livro para %s:\n", sides[s] == CELL_JAGUAR ? "a onca" : "os caes");
+		err = book_gen_expand (&bg, &game, sides[s], 0);
+	}
+
+	if ( err == 0 )
+		err = book_write (argv[1], bg.entries, bg.count);
+
+	if ( err == 0 )
+		printf ("%zu posicoes em %.1f s, gravadas em %s\n", bg.count, book_gen_now () - t0, argv[1]);
+
+	free (bg.entries);
+	free (bg.seen);
+	ai_release ();
+	return err == 0 ? 0 : 1;
+}
@@ -1,24 +1,132 @@
 #include "game.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* topologia do tabuleiro: construida uma unica vez (pthread_once, entao
+   game_init pode ser chamada de varias threads) e compartilhada por todos
+   os Game, somente leitura depois de pronta. Fora daqui o modulo nao tem
+   estado global: cada Game eh independente */
+static Graph board_graph;
+static int board_status = 0; /* resultado da construcao */
+static pthread_once_t board_once = PTHREAD_ONCE_INIT;
+
+/* numeros aleatorios do hash Zobrist, sorteados uma vez em game_init com
+   semente fixa (chaves iguais entre execucoes, ex.: livro de aberturas) */
+#define ZOBRIST_SEED 0x9E3779B97F4A7C15ULL
+
+static uint64_t zobrist_dog[GRAPH_MAX_VERTICES];
+static uint64_t zobrist_jaguar[GRAPH_MAX_VERTICES];
+static uint64_t zobrist_dog_to_move;
+
+/* as mesmas tabelas vistas no espelho (entrada v = entrada de mirror[v]):
+   Game.mirror_key eh a chave da posicao espelhada, mantida junto com a key */
+static uint64_t zobrist_dog_mirror[GRAPH_MAX_VERTICES];
+static uint64_t zobrist_jaguar_mirror[GRAPH_MAX_VERTICES];
+
+/* espelho de mascaras byte a byte: mirror_byte[i][b] eh a imagem dos
+   vertices 8i..8i+7 marcados em b */
+static Bitboard mirror_byte[8][256];
+
+/* tabelas por vertice da avaliacao, em pontos para a onca: Game.psq eh a
+   soma delas sobre as pecas, mantida por make/unmake */
+static int psq_dog[GRAPH_MAX_VERTICES];
+static int psq_jaguar[GRAPH_MAX_VERTICES];
+
+/* splitmix64: gerador pequeno e de boa qualidade para as tabelas */
+static uint64_t zobrist_next (uint64_t* state) {
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static void zobrist_init (void) {
+	uint64_t state = ZOBRIST_SEED;
+
+	for ( int v = 0; v < GRAPH_MAX_VERTICES; v++ ) {
+		zobrist_dog[v] = zobrist_next (&state);
+		zobrist_jaguar[v] = zobrist_next (&state);
+	}
+	zobrist_dog_to_move = zobrist_next (&state);
+
+	for ( int v = 0; v < board_graph.num_vertices; v++ ) {
+		zobrist_dog_mirror[v] = zobrist_dog[(int)board_graph.mirror[v]];
+		zobrist_jaguar_mirror[v] = zobrist_jaguar[(int)board_graph.mirror[v]];
+	}
+}
+
+static void mirror_init (void) {
+	for ( int i = 0; i < 8; i++ ) {
+		for ( int b = 0; b < 256; b++ ) {
+			Bitboard m = BB_EMPTY;
+			for ( int bit = 0; bit < 8; bit++ ) {
+				int v = i * 8 + bit;
+				if ( (b >> bit) & 1 && v < board_graph.num_vertices )
+					m |= BB_BIT (board_graph.mirror[v]);
+			}
+			mirror_byte[i][b] = m;
+		}
+	}
+}
+
+/* onca: vale mais onde tem mais vizinhos e saltos. Cao: vale menos (para
+   a onca) onde tem mais vizinhos, e mais onde pode ser saltado de mais
+   lados. Tudo vem do grafo, entao as tabelas respeitam o espelho */
+static void psq_init (void) {
+	const Graph* g = &board_graph;
+	int exposed[GRAPH_MAX_VERTICES] = { 0 };
+
+	for ( int v = 0; v < g->num_vertices; v++ ) {
+		for ( int k = 0; k < g->v[v].num_jumps; k++ )
+			exposed[(int)g->v[v].jumps[k].over]++;
+	}
+
+	for ( int v = 0; v < g->num_vertices; v++ ) {
+		psq_jaguar[v] = 2 * g->v[v].degree + 2 * g->v[v].num_jumps;
+		psq_dog[v] = 2 * exposed[v] - g->v[v].degree;
+	}
+}
+
+/* cria o grafo a partir do mapa ASCII, as tabelas Zobrist, as do espelho
+   e as da avaliacao */
+static void game_board_init (void) {
+	int err = graph_create (&board_graph, GAME_MAP_FILE);
+	if ( err != 0 ) {
+		fprintf (stderr, "game_init: graph_create falhou (err=%d)\n", err);
+		board_status = -2;
+		return;
+	}
+
+	zobrist_init ();
+	mirror_init ();
+	psq_init ();
+}
+
 int game_init (Game* game) {
 	if ( !game ) {
 		fprintf (stderr, "game_init: ponteiro game == NULL\n");
 		return -1;
 	}
 
-	/* cria o grafo interno a partir do mapa ASCII */
-	int err = graph_create (&game->g, GAME_MAP_FILE);
-	if ( err != 0 ) {
-		fprintf (stderr, "game_init: graph_create falhou (err=%d)\n", err);
-		return -2;
+	/* so a primeira chamada constroi o tabuleiro */
+	pthread_once (&board_once, game_board_init);
+	if ( board_status != 0 )
+		return board_status;
+
+	if ( board_graph.num_vertices > MOVE_MAX_CAPT_VERTICES ) {
+		fprintf (stderr,
+				 "game_init: grafo com %d vertices nao cabe em Move (max %d)\n",
+				 board_graph.num_vertices, MOVE_MAX_CAPT_VERTICES);
+		return -4;
 	}
 
+	game->g = &board_graph;
+
 	/* zera estado das pecas e contadores */
-	err = game_clear (game);
+	int err = game_clear (game);
 	if ( err != 0 ) {
 		fprintf (stderr, "game_init: game_clear falhou (err=%d)\n", err);
 		return -3;
@@ -26,6 +134,9 @@ int game_init (Game* game) {
 
 	/* lado padrao: onca comeca */
 	game->to_move = CELL_JAGUAR;
+	game->key = game_compute_key (game);
+	game->mirror_key = game_compute_mirror_key (game);
+	game->psq = game_compute_psq (game);
 
 	return 0;
 }
@@ -37,11 +148,9 @@ int game_clear (Game* game) {
 	}
 
 	/* limpa ocupacao de todas as casas */
-	for ( int i = 0; i < GRAPH_MAX_VERTICES; i++ )
-		game->cell_at[i] = CELL_EMPTY;
-
+	game->dogs = BB_EMPTY;
 	game->jaguar_pos = -1;
-	game->num_dogs = 0;
+	game->winner = game_compute_winner (game);
 
 	return 0;
 }
@@ -81,7 +190,7 @@ static MoveType ctrl_char_to_movtype (char ch) {
 static char movtype_to_ctrl_char (MoveType mt) {
 	if ( mt == MOVE_JUMP ) return CTRL_MOV_SALT;
 	if ( mt == MOVE_SIMPLE ) return CTRL_MOV_SIMP;
-	return NULL; /* qualquer coisa fora disso trata como vazio */
+	return '\0'; /* qualquer coisa fora disso trata como vazio */
 }
 
 int game_from_controller_board (Game* game, const char* board, char lado) {
@@ -118,7 +227,7 @@ int game_from_controller_board (Game* game, const char* board, char lado) {
 		if ( !ctrl_pos_valida (l, c) )
 			continue;
 
-		int vid = graph_get_index (&game->g, l, c);
+		int vid = graph_get_index (game->g, l, c);
 		if ( vid < 0 ) {
 			fprintf (stderr,
 					 "game_from_controller_board: sem vertice para (l=%d,c=%d)\n",
@@ -127,12 +236,230 @@ int game_from_controller_board (Game* game, const char* board, char lado) {
 		}
 
 		CellContent cell = ctrl_char_to_cell (ch);
-		game->cell_at[vid] = cell;
 
 		if ( cell == CELL_JAGUAR )
 			game->jaguar_pos = vid;
 		else if ( cell == CELL_DOG )
-			game->num_dogs++;
+			game->dogs |= BB_BIT (vid);
+	}
+
+	game->winner = game_compute_winner (game);
+	game->key = game_compute_key (game);
+	game->mirror_key = game_compute_mirror_key (game);
+	game->psq = game_compute_psq (game);
+	return 0;
+}
+
+uint64_t game_compute_key (const Game* game) {
+	uint64_t key = 0;
+	Bitboard dogs = game->dogs;
+
+	while ( dogs )
+		key ^= zobrist_dog[bb_pop_lsb (&dogs)];
+
+	if ( game->jaguar_pos >= 0 )
+		key ^= zobrist_jaguar[game->jaguar_pos];
+
+	if ( game->to_move == CELL_DOG )
+		key ^= zobrist_dog_to_move;
+
+	return key;
+}
+
+uint64_t game_compute_mirror_key (const Game* game) {
+	uint64_t key = 0;
+	Bitboard dogs = game->dogs;
+
+	while ( dogs )
+		key ^= zobrist_dog_mirror[bb_pop_lsb (&dogs)];
+
+	if ( game->jaguar_pos >= 0 )
+		key ^= zobrist_jaguar_mirror[game->jaguar_pos];
+
+	if ( game->to_move == CELL_DOG )
+		key ^= zobrist_dog_to_move;
+
+	return key;
+}
+
+int game_compute_psq (const Game* game) {
+	int psq = 0;
+	Bitboard dogs = game->dogs;
+
+	while ( dogs )
+		psq += psq_dog[bb_pop_lsb (&dogs)];
+
+	if ( game->jaguar_pos >= 0 )
+		psq += psq_jaguar[game->jaguar_pos];
+
+	return psq;
+}
+
+Bitboard game_mirror_mask (Bitboard set) {
+	Bitboard m = BB_EMPTY;
+
+	for ( int i = 0; set; i++, set >>= 8 )
+		m |= mirror_byte[i][set & 0xff];
+	return m;
+}
+
+int game_mirror_needed (const Game* game) {
+	if ( game->jaguar_pos >= 0 ) {
+		int m = game->g->mirror[game->jaguar_pos];
+		if ( m != game->jaguar_pos )
+			return m < game->jaguar_pos;
+	}
+
+	/* onca no eixo (ou fora do tabuleiro): desempata pelos caes */
+	return game_mirror_mask (game->dogs) < game->dogs;
+}
+
+Move game_mirror_move (const Game* game, Move mv) {
+	if ( mv == MOVE_NONE )
+		return mv;
+
+	return move_make (move_side (mv), move_type (mv), game->g->mirror[move_from (mv)],
+					  game->g->mirror[move_to (mv)], game_mirror_mask (move_captured (mv)));
+}
+
+void game_mirror (Game* game) {
+	uint64_t key = game->key;
+
+	game->dogs = game_mirror_mask (game->dogs);
+	if ( game->jaguar_pos >= 0 )
+		game->jaguar_pos = game->g->mirror[game->jaguar_pos];
+
+	/* o vencedor nao muda: o espelho eh simetria do tabuleiro */
+	game->key = game->mirror_key;
+	game->mirror_key = key;
+}
+
+/* procura, em profundidade, uma ordem de saltos que leve a onca de cur ate
+   to capturando exatamente os caes de left; dogs eh a ocupacao no momento */
+static int game_find_jump_chain (const Graph* g, int cur, int to, Bitboard left, Bitboard dogs,
+								 int path[], int depth, int* path_len) {
+	if ( !left ) {
+		if ( cur != to )
+			return 0;
+
+		*path_len = depth + 1;
+		return 1;
+	}
+
+	if ( depth + 1 >= GAME_MAX_PATH )
+		return 0;
+
+	const Vertex* v = &g->v[cur];
+
+	for ( int k = 0; k < v->num_jumps; k++ ) {
+		int over = v->jumps[k].over;
+		int land = v->jumps[k].land;
+
+		if ( !bb_test (left, over) || bb_test (dogs, land) )
+			continue;
+
+		path[depth + 1] = land;
+
+		if ( game_find_jump_chain (g, land, to, left & ~BB_BIT (over), dogs & ~BB_BIT (over),
+								   path, depth + 1, path_len) )
+			return 1;
+	}
+
+	return 0;
+}
+
+int game_move_from_path (const Game* game, const MovePath* path, Move* mv) {
+	if ( !game || !path || !mv ) {
+		fprintf (stderr, "game_move_from_path: ponteiro nulo\n");
+		return -1;
+	}
+
+	if ( path->path_len < 2 || path->path_len > GAME_MAX_PATH ) {
+		fprintf (stderr,
+				 "game_move_from_path: path_len invalido (%d)\n", path->path_len);
+		return -2;
+	}
+
+	for ( int k = 0; k < path->path_len; k++ ) {
+		if ( path->path[k] < 0 || path->path[k] >= game->g->num_vertices ) {
+			fprintf (stderr,
+					 "game_move_from_path: vid invalido (%d)\n", path->path[k]);
+			return -3;
+		}
+	}
+
+	int from = path->path[0];
+	int to = path->path[path->path_len - 1];
+
+	if ( path->type == MOVE_SIMPLE ) {
+		if ( path->path_len != 2 ) {
+			fprintf (stderr,
+					 "game_move_from_path: movimento simples com %d vertices\n",
+					 path->path_len);
+			return -4;
+		}
+
+		*mv = move_make (path->side, MOVE_SIMPLE, from, to, BB_EMPTY);
+		return 0;
+	}
+
+	if ( path->type != MOVE_JUMP ) {
+		fprintf (stderr, "game_move_from_path: tipo invalido (%d)\n", path->type);
+		return -5;
+	}
+
+	/* cada passo deve ser um salto da tabela; o meio vira captura */
+	Bitboard captured = BB_EMPTY;
+
+	for ( int k = 0; k < path->path_len - 1; k++ ) {
+		int mid = graph_get_mid_jump (game->g, path->path[k], path->path[k + 1]);
+		if ( mid < 0 || bb_test (captured, mid) ) {
+			fprintf (stderr,
+					 "game_move_from_path: passo %d nao eh um salto valido\n", k);
+			return -6;
+		}
+
+		captured |= BB_BIT (mid);
+	}
+
+	*mv = move_make (path->side, MOVE_JUMP, from, to, captured);
+	return 0;
+}
+
+int game_move_to_path (const Game* game, Move mv, MovePath* path) {
+	if ( !game || !path ) {
+		fprintf (stderr, "game_move_to_path: ponteiro nulo\n");
+		return -1;
+	}
+
+	int from = move_from (mv);
+	int to = move_to (mv);
+
+	if ( from >= game->g->num_vertices || to >= game->g->num_vertices ) {
+		fprintf (stderr,
+				 "game_move_to_path: vid invalido (from=%d, to=%d)\n", from, to);
+		return -2;
+	}
+
+	path->type = move_type (mv);
+	path->side = move_side (mv);
+	path->path[0] = from;
+
+	if ( path->type == MOVE_SIMPLE ) {
+		path->path[1] = to;
+		path->path_len = 2;
+		return 0;
+	}
+
+	if ( path->type != MOVE_JUMP ) {
+		fprintf (stderr, "game_move_to_path: tipo invalido (%d)\n", path->type);
+		return -3;
+	}
+
+	if ( !game_find_jump_chain (game->g, from, to, move_captured (mv), game->dogs,
+								path->path, 0, &path->path_len) ) {
+		fprintf (stderr, "game_move_to_path: nenhuma sequencia de saltos valida\n");
+		return -4;
 	}
 
 	return 0;
@@ -149,6 +476,7 @@ int game_move_from_controller (const Game* game, const char* jogada, Move* mv) {
 	char lado_ch;
 	char tipo_ch;
 	int n, pos = 0;
+	MovePath p;
 
 	/* lado */
 	if ( sscanf (&jogada[pos], "%c %c%n", &lado_ch, &tipo_ch, &n) != 2 ) {
@@ -159,26 +487,25 @@ int game_move_from_controller (const Game* game, const char* jogada, Move* mv) {
 	}
 	pos += n;
 
-	mv->side = ctrl_char_to_cell (lado_ch);
-	if ( mv->side == CELL_EMPTY ) {
+	p.side = ctrl_char_to_cell (lado_ch);
+	if ( p.side == CELL_EMPTY ) {
 		fprintf (stderr,
 				 "game_move_from_controller: lado invalido '%c'\n", lado_ch);
 		return -4;
 	}
 
-	mv->type = ctrl_char_to_movtype (tipo_ch);
+	p.type = ctrl_char_to_movtype (tipo_ch);
 
-	if ( mv->type == MOVE_ERR ) {
+	if ( p.type == MOVE_ERR ) {
 		fprintf (stderr,
 				 "game_move_from_controller: tipo invalido '%c'\n", tipo_ch);
 		return -6;
 	}
 
-	mv->path_len = 2;
+	p.path_len = 2;
 
-	if ( mv->type == MOVE_JUMP ) {
+	if ( p.type == MOVE_JUMP ) {
 		int ns;
-		printf ("teste");
 
 		if ( sscanf (&jogada[pos], "%d%n", &ns, &n) != 1 ) {
 			fprintf (stderr,
@@ -186,26 +513,26 @@ int game_move_from_controller (const Game* game, const char* jogada, Move* mv) {
 			return -11;
 		}
 		pos += n;
-		mv->path_len = ns + 1;
+		p.path_len = ns + 1;
 	}
 
-	if ( mv->path_len > GRAPH_MAX_VERTICES ) {
+	if ( p.path_len < 2 || p.path_len > GAME_MAX_PATH ) {
 		fprintf (stderr,
 				 "game_move_from_controller: path estourou limite\n");
 		return -10;
 	}
 
-	for ( int k = 0; k < mv->path_len; k++ ) {
+	for ( int k = 0; k < p.path_len; k++ ) {
 		int l, c;
 
 		if ( sscanf (&jogada[pos], "%d %d%n", &l, &c, &n) != 2 ) {
 			fprintf (stderr,
-					 "game_move_from_controller: erro lendo coordenada (k=%d, l=%d, c=%d) jogada=%s pos=%d\n", k, l, c, jogada, pos - n);
+					 "game_move_from_controller: erro lendo coordenada (k=%d) jogada=%s\n", k, jogada);
 			return -7;
 		}
 		pos += n;
 
-		int vid = graph_get_index (&game->g, l, c);
+		int vid = graph_get_index (game->g, l, c);
 		if ( vid < 0 ) {
 			fprintf (stderr,
 					 "game_move_from_controller: sem vertice para (l=%d,c=%d)\n",
@@ -213,34 +540,40 @@ int game_move_from_controller (const Game* game, const char* jogada, Move* mv) {
 			return -9;
 		}
 
-		mv->path[k] = vid;
+		p.path[k] = vid;
+	}
+
+	if ( game_move_from_path (game, &p, mv) != 0 ) {
+		fprintf (stderr,
+				 "game_move_from_controller: caminho invalido em '%s'\n", jogada);
+		return -12;
 	}
 
 	return 0;
 }
 
-int game_move_to_controller (const Game* game, const Move* mv, char* buf, int bufsize) {
-	if ( !game || !mv || !buf || bufsize <= 0 ) {
+int game_move_to_controller (const Game* game, Move mv, char* buf, int bufsize) {
+	if ( !game || !buf || bufsize <= 0 ) {
 		fprintf (stderr,
 				 "game_move_to_controller: ponteiro nulo ou bufsize invalido\n");
 		return -1;
 	}
 
-	if ( mv->path_len <= 0 || mv->path_len > GRAPH_MAX_VERTICES ) {
+	MovePath p;
+	if ( game_move_to_path (game, mv, &p) != 0 ) {
 		fprintf (stderr,
-				 "game_move_to_controller: path_len invalido (%d)\n",
-				 mv->path_len);
+				 "game_move_to_controller: movimento nao pode ser expandido\n");
 		return -2;
 	}
 
-	char lado_ch = cell_to_ctrl_char (mv->side);
+	char lado_ch = cell_to_ctrl_char (p.side);
 	if ( lado_ch == '-' ) {
 		fprintf (stderr,
 				 "game_move_to_controller: lado invalido no Move\n");
 		return -3;
 	}
 
-	char tipo_ch = movtype_to_ctrl_char (mv->type);
+	char tipo_ch = movtype_to_ctrl_char (p.type);
 	if ( !tipo_ch ) {
 		fprintf (stderr,
 				 "game_move_to_controller: tipo de movimento invalido\n");
@@ -260,8 +593,8 @@ int game_move_to_controller (const Game* game, const Move* mv, char* buf, int bu
 	used += written;
 
 	/* numero de saltos se for 's' */
-	if ( mv->type == MOVE_JUMP ) {
-		int ns = mv->path_len - 1; /* n saltos => n+1 posicoes */
+	if ( p.type == MOVE_JUMP ) {
+		int ns = p.path_len - 1; /* n saltos => n+1 posicoes */
 		written = snprintf (&buf[used], bufsize - used, " %d", ns);
 		if ( written < 0 || written >= bufsize - used ) {
 			fprintf (stderr,
@@ -272,17 +605,11 @@ int game_move_to_controller (const Game* game, const Move* mv, char* buf, int bu
 	}
 
 	/* coordenadas: l c para cada vertice do caminho */
-	for ( int k = 0; k < mv->path_len; k++ ) {
-		int vid = mv->path[k];
+	for ( int k = 0; k < p.path_len; k++ ) {
+		int vid = p.path[k];
 
-		if ( vid < 0 || vid >= game->g.num_vertices ) {
-			fprintf (stderr,
-					 "game_move_to_controller: vid invalido (%d)\n", vid);
-			return -7;
-		}
-
-		int l = game->g.v[vid].c.row;
-		int c = game->g.v[vid].c.col;
+		int l = game->g->v[vid].c.row;
+		int c = game->g->v[vid].c.col;
 
 		written = snprintf (&buf[used], bufsize - used,
 							" %d %d", l, c);
@@ -325,14 +652,14 @@ void game_print_board (const Game* game) {
 			}
 
 			/* Obtem id do vertice */
-			int vid = graph_get_index (&game->g, gl, gc);
+			int vid = graph_get_index (game->g, gl, gc);
 			if ( vid < 0 ) {
 				putchar ('#'); /* erro no grafo → usa # */
 				continue;
 			}
 
 			/* Conteúdo da célula */
-			CellContent cc = game->cell_at[vid];
+			CellContent cc = game_cell_at (game, vid);
 
 			char ch = cell_to_ctrl_char (cc);
 			putchar (ch);
@@ -353,367 +680,514 @@ int graph_is_valid_coord (int row, int col) {
 	return 1;
 }
 
-static int game_is_straight_jump (const Game* g, int from, int mid, int to) {
-	int lf = g->g.v[from].c.row;
-	int cf = g->g.v[from].c.col;
-
-	int lm = g->g.v[mid].c.row;
-	int cm = g->g.v[mid].c.col;
-
-	int lt = g->g.v[to].c.row;
-	int ct = g->g.v[to].c.col;
-
-	int v1x = lm - lf;
-	int v1y = cm - cf;
-	int v2x = lt - lm;
-	int v2y = ct - cm;
-
-	/* produto vetorial em 2D = 0 => colinear */
-	int cross = v1x * v2y - v1y * v2x;
-
-	return (cross == 0);
-}
-
-int game_is_legal_move (const Game* g, const Move* mv) {
-	if ( mv->path_len < 2 ) {
-		/* caminho vazio ou grande demais */
-		return 0;
-	}
+int game_is_legal_move (const Game* g, Move mv) {
+	int from = move_from (mv);
+	int to = move_to (mv);
+	CellContent side = move_side (mv);
 
 	/* confere indices e origem */
-	for ( int k = 0; k < mv->path_len; k++ ) {
-		int vid = mv->path[k];
-		if ( vid < 0 || vid >= g->g.num_vertices )
-			return 0;
-	}
+	if ( from >= g->g->num_vertices || to >= g->g->num_vertices )
+		return 0;
 
-	int from = mv->path[0];
-	int to = mv->path[1];
-	if ( g->cell_at[from] != mv->side ) {
+	if ( game_cell_at (g, from) != side ) {
 		/* origem nao contem peca do lado que joga */
 		return 0;
 	}
 
-	if ( from == to )
-		return 0;
+	Bitboard empty = game_empty_mask (g);
 
-	/* --- movimentos dos caes --- */
-	if ( mv->side == CELL_DOG ) {
-		if ( mv->type != MOVE_SIMPLE )
+	/* --- movimentos simples (caes ou onca) --- */
+	if ( move_type (mv) == MOVE_SIMPLE ) {
+		if ( side != CELL_DOG && side != CELL_JAGUAR )
 			return 0;
 
-		if ( !graph_is_neighbor (&g->g, from, to) )
+		if ( move_captured (mv) || from == to )
 			return 0;
 
-		if ( g->cell_at[to] != CELL_EMPTY )
+		if ( !bb_test (g->g->v[from].adj & empty, to) )
 			return 0;
 
 		return 1;
 	}
 
-	/* a partir daqui, estamos tratando a onca */
+	/* --- salto(s) da onca --- */
+	if ( move_type (mv) == MOVE_JUMP ) {
+		Bitboard captured = move_captured (mv);
 
-	if ( mv->side != CELL_JAGUAR )
-		return 0;
-
-	/* movimento simples da onca */
-	if ( mv->type == MOVE_SIMPLE ) {
-		if ( !graph_is_neighbor (&g->g, from, to) )
+		if ( side != CELL_JAGUAR )
 			return 0;
 
-		if ( g->cell_at[to] != CELL_EMPTY )
+		/* precisa capturar algo, e so caes que estao no tabuleiro;
+		   uma cadeia pode terminar na propria origem */
+		if ( !captured || (captured & ~g->dogs) )
 			return 0;
 
-		return 1;
-	}
-
-	/* salto(s) da onca */
-	if ( mv->type == MOVE_JUMP ) {
-		/* posicao inicial deve bater com onde a onca esta */
-		if ( from != g->jaguar_pos )
-			return 0;
-
-		int current = from;
-
-		for ( int k = 0; k < mv->path_len - 1; k++ ) {
-			int to = mv->path[k + 1];
-			if ( current == to )
-				return 0;
-
-			int mid = graph_get_mid_jump (&g->g, current, to);
-			if ( mid < 0 )
-				return 0;
-
-			if ( !game_is_straight_jump (g, from, mid, to) )
-				return 0;
-
-			if ( !graph_is_neighbor (&g->g, from, mid) && !graph_is_neighbor (&g->g, mid, to) )
-				return 0;
-
-			/* casa intermediaria deve ter cao, destino deve estar vazio */
-			if ( g->cell_at[mid] != CELL_DOG )
-				return 0;
-			if ( g->cell_at[to] != CELL_EMPTY )
-				return 0;
-
-			/* opcional: garantir que from/to sao "saltaveis":
-			   voce pode adicionar checks extras de geometria aqui se quiser */
-
-			current = to;
-		}
-
-		return 1;
+		MovePath p;
+		return game_find_jump_chain (g->g, from, to, captured, g->dogs, p.path, 0, &p.path_len);
 	}
 
 	/* tipo desconhecido */
 	return 0;
 }
 
-int graph_get_mid_jump (const Graph* g, int from_vid, int to_vid) {
-	int lf = g->v[from_vid].c.row;
-	int cf = g->v[from_vid].c.col;
-
-	int lt = g->v[to_vid].c.row;
-	int ct = g->v[to_vid].c.col;
-
-	int lm = (lf + lt) / 2;
-	int cm = (cf + ct) / 2;
-
-	return graph_get_index (g, lm, cm);
-}
-
 static CellContent opposite_side (CellContent s) {
 	if ( s == CELL_JAGUAR ) return CELL_DOG;
 	if ( s == CELL_DOG ) return CELL_JAGUAR;
 	return s;
 }
 
-int game_apply_move (Game* game, const Move* mv) {
-	CellContent side = mv->side;
-
-	/* -------- movimento simples (um passo) -------- */
-	if ( mv->type == MOVE_SIMPLE ) {
-		int from = mv->path[0];
-		int to = mv->path[1];
-
-		/* aqui assumimos que indices sao validos e o movimento eh legal */
+int game_make_move (Game* game, Move mv, GameUndo* undo) {
+	int from = move_from (mv);
+	int to = move_to (mv);
+
+	/* guarda o necessario para desfazer */
+	undo->captured = move_captured (mv);
+	undo->jaguar_pos = game->jaguar_pos;
+	undo->to_move = game->to_move;
+	undo->winner = game->winner;
+	undo->key = game->key;
+	undo->mirror_key = game->mirror_key;
+	undo->psq = game->psq;
+
+	/* aqui assumimos que indices sao validos e o movimento eh legal */
+
+	switch ( move_type (mv) ) {
+		case MOVE_SIMPLE:
+			if ( move_side (mv) == CELL_JAGUAR ) {
+				game->jaguar_pos = to;
+				game->key ^= zobrist_jaguar[from] ^ zobrist_jaguar[to];
+				game->mirror_key ^= zobrist_jaguar_mirror[from] ^ zobrist_jaguar_mirror[to];
+				game->psq += psq_jaguar[to] - psq_jaguar[from];
+			} else {
+				game->dogs ^= BB_BIT (from) | BB_BIT (to);
+				game->key ^= zobrist_dog[from] ^ zobrist_dog[to];
+				game->mirror_key ^= zobrist_dog_mirror[from] ^ zobrist_dog_mirror[to];
+				game->psq += psq_dog[to] - psq_dog[from];
+			}
+			break;
 
-		game->cell_at[from] = CELL_EMPTY;
-		game->cell_at[to] = side;
+		case MOVE_JUMP: {
+			/* salto(s) da onca: os caes capturados saem, a onca vai ao destino */
+			Bitboard captured = undo->captured;
 
-		if ( side == CELL_JAGUAR )
+			game->dogs &= ~captured;
 			game->jaguar_pos = to;
+			game->key ^= zobrist_jaguar[from] ^ zobrist_jaguar[to];
+			game->mirror_key ^= zobrist_jaguar_mirror[from] ^ zobrist_jaguar_mirror[to];
+			game->psq += psq_jaguar[to] - psq_jaguar[from];
+			while ( captured ) {
+				int v = bb_pop_lsb (&captured);
+				game->key ^= zobrist_dog[v];
+				game->mirror_key ^= zobrist_dog_mirror[v];
+				game->psq -= psq_dog[v];
+			}
+			break;
+		}
 
-		game->to_move = opposite_side (game->to_move);
-		return 0;
+		default:
+			fprintf (stderr,
+					 "game_make_move: tipo de movimento desconhecido (%d)\n",
+					 move_type (mv));
+			return -5;
 	}
 
-	/* -------- salto(s) da onca -------- */
-	if ( mv->type == MOVE_JUMP ) {
-		/* assumimos que so a onca usa MOVE_JUMP e que path eh valido */
-		int current = mv->path[0];
-
-		for ( int k = 0; k < mv->path_len - 1; k++ ) {
-			int from = current;
-			int to = mv->path[k + 1];
+	game->to_move = opposite_side (game->to_move);
+	game->key ^= zobrist_dog_to_move;
+	game->mirror_key ^= zobrist_dog_to_move;
+	game->winner = game_compute_winner (game);
+	return 0;
+}
 
-			int mid = graph_get_mid_jump (&game->g, from, to);
+void game_unmake_move (Game* game, Move mv, const GameUndo* undo) {
+	if ( move_side (mv) == CELL_DOG )
+		game->dogs ^= BB_BIT (move_from (mv)) | BB_BIT (move_to (mv));
+
+	game->dogs |= undo->captured;
+	game->jaguar_pos = undo->jaguar_pos;
+	game->to_move = undo->to_move;
+	game->winner = undo->winner;
+	game->key = undo->key;
+	game->mirror_key = undo->mirror_key;
+	game->psq = undo->psq;
+}
 
-			/* aplica o salto:
-			   - remove onca da origem
-			   - remove cao do meio
-			   - coloca onca no destino */
-			game->cell_at[from] = CELL_EMPTY;
-			game->cell_at[mid] = CELL_EMPTY;
-			game->cell_at[to] = CELL_JAGUAR;
+void game_make_null_move (Game* game, GameUndo* undo) {
+	undo->captured = BB_EMPTY;
+	undo->jaguar_pos = game->jaguar_pos;
+	undo->to_move = game->to_move;
+	undo->winner = game->winner;
+	undo->key = game->key;
+	undo->mirror_key = game->mirror_key;
+	undo->psq = game->psq;
+
+	/* nenhuma peca muda: so o lado a jogar (e o vencedor continua o mesmo) */
+	game->to_move = opposite_side (game->to_move);
+	game->key ^= zobrist_dog_to_move;
+	game->mirror_key ^= zobrist_dog_to_move;
+}
 
-			game->num_dogs--;
-			current = to;
-		}
+void game_unmake_null_move (Game* game, const GameUndo* undo) {
+	game->to_move = undo->to_move;
+	game->key = undo->key;
+	game->mirror_key = undo->mirror_key;
+}
 
-		game->jaguar_pos = current;
-		game->to_move = opposite_side (game->to_move);
-		return 0;
-	}
+int game_apply_move (Game* game, Move mv) {
+	GameUndo undo;
+	return game_make_move (game, mv, &undo);
+}
 
-	fprintf (stderr,
-			 "game_apply_move: tipo de movimento desconhecido (%d)\n",
-			 mv->type);
-	return -5;
+int game_get_winner (const Game* g, CellContent* winner) {
+	/* mantido por game_make_move/game_unmake_move (game_compute_winner):
+	   onca vence com ate GAME_JAGUAR_WIN_DOGS caes, caes vencem se ela
+	   nao tiver movimento */
+	*winner = g->winner;
+	return g->winner != CELL_EMPTY;
 }
 
-/* verifica se a onca tem algum movimento legal a partir do estado atual */
-static int game_jaguar_has_legal_move (const Game* g) {
-	int jpos = g->jaguar_pos;
+/* estado da enumeracao das cadeias de saltos da onca */
+typedef struct {
+	const Graph* g;
+	int from; /* vertice de partida da onca */
+
+	Move* moves;	/* lista de saida */
+	int max_moves;	/* capacidade de moves[] */
+	int* out_count; /* movimentos ja na lista */
+	int overflow;	/* moves[] ou visited[] encheu */
+
+	/* estados (destino, capturados) ja expandidos: outra ordem das mesmas
+	   capturas chega ao mesmo estado e nao precisa ser explorada de novo.
+	   Cada estado entra uma vez, entao cada lance tambem sai uma vez. As
+	   listas por destino evitam varrer todos os estados a cada salto */
+	GameJumpTable* t;
+	int num_visited;
+} JumpChainGen;
+
+static void game_emit_jump (JumpChainGen* jg, int to, Bitboard captured) {
+	if ( *jg->out_count >= jg->max_moves ) {
+		jg->overflow = 1;
+		return;
+	}
 
-	if ( jpos < 0 || jpos >= g->g.num_vertices )
-		return 0;
-	if ( g->cell_at[jpos] != CELL_JAGUAR )
-		return 0;
+	jg->moves[(*jg->out_count)++] = move_make (CELL_JAGUAR, MOVE_JUMP, jg->from, to, captured);
+}
 
-	int neigh[GRAPH_MAX_NEIGHBORS];
-	int deg = 0;
-	if ( graph_get_neighbors (&g->g, jpos, neigh, &deg) < 0 )
-		return 0;
+/* registra o estado (land, captured); 0 se ja tinha sido visto */
+static int game_visit_jump_state (JumpChainGen* jg, int land, Bitboard captured) {
+	Move state = move_make (CELL_JAGUAR, MOVE_JUMP, jg->from, land, captured);
 
-	Move mv;
+	GameJumpTable* t = jg->t;
 
-	mv.side = CELL_JAGUAR;
-	mv.path[0] = jpos;
-	mv.type = MOVE_SIMPLE;
-	mv.path_len = 2; /* simples ou 1 salto: origem + destino */
+	for ( int i = t->first_visited[land]; i >= 0; i = t->next_visited[i] ) {
+		if ( t->visited[i] == state )
+			return 0;
+	}
 
-	/* --- movimentos simples da onca --- */
-	for ( int i = 0; i < deg; i++ ) {
-		mv.path[1] = neigh[i];
-		if ( game_is_legal_move (g, &mv) == 1 )
-			return 1;
+	if ( jg->num_visited >= GAME_MAX_JUMP_STATES ) {
+		jg->overflow = 1;
+		return 0;
 	}
 
-	/* --- saltos: onca em jpos, cao em mid, destino vazio em dest --- */
+	int i = jg->num_visited++;
+	t->visited[i] = state;
+	t->next_visited[i] = t->first_visited[land];
+	t->first_visited[land] = (int16_t)i;
+	return 1;
+}
 
-	int neigh_mid[GRAPH_MAX_NEIGHBORS];
-	int deg_mid = 0;
-	mv.type = MOVE_JUMP;
+/* expande a cadeia com a onca em cur, ja tendo capturado captured;
+   dogs eh a ocupacao dos caes neste ponto da cadeia */
+static void game_gen_jump_chains (JumpChainGen* jg, int cur, Bitboard captured, Bitboard dogs) {
+	const Vertex* v = &jg->g->v[cur];
+	int extended = 0;
 
-	for ( int i = 0; i < deg; i++ ) {
-		int mid = neigh[i];
+	for ( int k = 0; k < v->num_jumps && !jg->overflow; k++ ) {
+		int over = v->jumps[k].over;
+		int land = v->jumps[k].land;
 
-		if ( g->cell_at[mid] != CELL_DOG )
+		/* precisa de cao no meio e destino livre (a origem ja foi liberada) */
+		if ( !bb_test (dogs, over) || bb_test (dogs, land) )
 			continue;
 
-		if ( graph_get_neighbors (&g->g, mid, neigh_mid, &deg_mid) < 0 )
+		extended = 1;
+
+		Bitboard next = captured | BB_BIT (over);
+		if ( !game_visit_jump_state (jg, land, next) )
 			continue;
 
-		for ( int j = 0; j < deg_mid; j++ ) {
-			mv.path[1] = neigh_mid[j];
+#if GAME_JUMP_PREFIXES
+		game_emit_jump (jg, land, next);
+#endif
 
-			if ( game_is_legal_move (g, &mv) == 1 )
-				return 1;
-		}
+		game_gen_jump_chains (jg, land, next, dogs & ~BB_BIT (over));
 	}
 
-	return 0;
+#if !GAME_JUMP_PREFIXES
+	if ( !extended && captured )
+		game_emit_jump (jg, cur, captured);
+#else
+	(void)extended;
+#endif
 }
 
-int game_get_winner (const Game* g, CellContent* winner) {
-	*winner = CELL_EMPTY;
+/* acrescenta em moves[] as cadeias de captura da onca (se for a vez dela);
+   -1 se a lista ou a tabela de estados encheu */
+static int game_append_captures (const Game* game, Move moves[], int max_moves, int* out_count,
+								 GameJumpTable* jumps) {
+	int jpos = game->jaguar_pos;
 
-	/* regra da onca: ganha se restarem 9 ou menos caes */
-	if ( g->num_dogs <= 9 ) {
-		*winner = CELL_JAGUAR;
-		return 1;
-	}
+	if ( game->to_move != CELL_JAGUAR || jpos < 0 || jpos >= game->g->num_vertices )
+		return 0;
 
-	/* se a onca nao tiver movimentos legais, caes vencem */
-	if ( !game_jaguar_has_legal_move (g) ) {
-		*winner = CELL_DOG;
-		return 1;
-	}
+	/* sem primeiro salto nao ha cadeia: poupa montar o estado */
+	if ( !(game->g->v[jpos].jump_land & ~(game->dogs | BB_BIT (jpos))) )
+		return 0;
 
-	return 0; /* ninguem venceu ainda */
+	JumpChainGen jg;
+	jg.g = game->g;
+	jg.from = jpos;
+	jg.moves = moves;
+	jg.max_moves = max_moves;
+	jg.out_count = out_count;
+	jg.overflow = 0;
+	jg.t = jumps;
+	jg.num_visited = 0;
+	memset (jumps->first_visited, -1, sizeof jumps->first_visited);
+
+	game_gen_jump_chains (&jg, jpos, BB_EMPTY, game->dogs);
+	return jg.overflow ? -1 : 0;
 }
 
-int game_generate_moves (const Game* game, Move moves[], int max_moves, int* out_count) {
-	*out_count = 0;
-
-	CellContent side = game->to_move;
+/* acrescenta em moves[] os movimentos simples do lado a jogar; -1 se a
+   lista encheu */
+static int game_append_quiets (const Game* game, Move moves[], int max_moves, int* out_count) {
+	Bitboard empty = game_empty_mask (game);
 
 	/* ---------------- CÃES: apenas movimentos simples ---------------- */
-	if ( side == CELL_DOG ) {
-		for ( int vid = 0; vid < game->g.num_vertices; vid++ ) {
-			if ( game->cell_at[vid] != CELL_DOG )
-				continue;
-
-			int neigh[GRAPH_MAX_NEIGHBORS];
-			int deg = 0;
+	if ( game->to_move == CELL_DOG ) {
+		Bitboard dogs = game->dogs;
 
-			if ( graph_get_neighbors (&game->g, vid, neigh, &deg) != 0 )
-				continue;
+		while ( dogs ) {
+			int vid = bb_pop_lsb (&dogs);
 
-			for ( int i = 0; i < deg; i++ ) {
+			/* destinos: vizinhos vazios do cao */
+			Bitboard dests = game->g->v[vid].adj & empty;
+			while ( dests ) {
 				if ( *out_count >= max_moves )
-					return 0; /* truncado, mas sem erro */
-
-				Move mv;
-				mv.side = CELL_DOG;
-				mv.type = MOVE_SIMPLE;
-				mv.path_len = 2;
-				mv.path[0] = vid;
-				mv.path[1] = neigh[i];
+					return -1;
 
-				if ( game_is_legal_move (game, &mv) == 1 )
-					moves[(*out_count)++] = mv;
+				moves[(*out_count)++] = move_make (CELL_DOG, MOVE_SIMPLE, vid, bb_pop_lsb (&dests), BB_EMPTY);
 			}
 		}
 		return 0;
 	}
 
-	/* ---------------- ONÇA: movimentos simples + saltos ---------------- */
+	/* ---------------- ONÇA: passos para vizinhos vazios ---------------- */
+	int jpos = game->jaguar_pos;
 
-	if ( side != CELL_JAGUAR ) {
-		/* lado desconhecido: nenhum movimento */
+	if ( game->to_move != CELL_JAGUAR || jpos < 0 || jpos >= game->g->num_vertices )
 		return 0;
+
+	Bitboard dests = game->g->v[jpos].adj & empty;
+	while ( dests ) {
+		if ( *out_count >= max_moves )
+			return -1;
+
+		moves[(*out_count)++] = move_make (CELL_JAGUAR, MOVE_SIMPLE, jpos, bb_pop_lsb (&dests), BB_EMPTY);
 	}
+	return 0;
+}
 
-	int jpos = game->jaguar_pos;
-	if ( jpos < 0 || jpos >= game->g.num_vertices )
-		return 0;
-	if ( game->cell_at[jpos] != CELL_JAGUAR )
-		return 0;
+int game_generate_captures (const Game* game, Move moves[], int max_moves, int* out_count, GameJumpTable* jumps) {
+	*out_count = 0;
+	if ( game_append_captures (game, moves, max_moves, out_count, jumps) != 0 ) {
+		fprintf (stderr, "game_generate_captures: lista cheia (max_moves=%d)\n", max_moves);
+		return -1;
+	}
+	return 0;
+}
 
-	int neigh[GRAPH_MAX_NEIGHBORS];
-	int deg = 0;
+int game_generate_quiets (const Game* game, Move moves[], int max_moves, int* out_count) {
+	*out_count = 0;
+	if ( game_append_quiets (game, moves, max_moves, out_count) != 0 ) {
+		fprintf (stderr, "game_generate_quiets: lista cheia (max_moves=%d)\n", max_moves);
+		return -1;
+	}
+	return 0;
+}
 
-	if ( graph_get_neighbors (&game->g, jpos, neigh, &deg) != 0 )
-		return 0;
+int game_generate_moves (const Game* game, Move moves[], int max_moves, int* out_count, GameJumpTable* jumps) {
+	/* os movimentos saem legais por construcao (vizinhos vazios e tabela
+	   de saltos), sem passar por game_is_legal_move; capturas primeiro */
+	*out_count = 0;
+	if ( game_append_captures (game, moves, max_moves, out_count, jumps) != 0 ||
+		 game_append_quiets (game, moves, max_moves, out_count) != 0 ) {
+		fprintf (stderr, "game_generate_moves: lista cheia (max_moves=%d)\n", max_moves);
+		return -1;
+	}
+	return 0;
+}
 
-	/* --- movimentos simples da onça --- */
-	for ( int i = 0; i < deg; i++ ) {
-		if ( *out_count >= max_moves )
-			return 0;
+/* ---------------- Gerador em estagios ---------------- */
 
-		Move mv;
-		mv.side = CELL_JAGUAR;
-		mv.type = MOVE_SIMPLE;
-		mv.path_len = 2;
-		mv.path[0] = jpos;
-		mv.path[1] = neigh[i];
+/* a cadeia de mv nao tem mais salto no destino (cadeia maximal) */
+static int game_jump_is_maximal (const Game* game, Move mv) {
+	const Vertex* v = &game->g->v[move_to (mv)];
+	Bitboard dogs = game->dogs & ~move_captured (mv);
 
-		if ( game_is_legal_move (game, &mv) == 1 )
-			moves[(*out_count)++] = mv;
+	for ( int k = 0; k < v->num_jumps; k++ ) {
+		if ( bb_test (dogs, v->jumps[k].over) && !bb_test (dogs, v->jumps[k].land) )
+			return 0;
 	}
+	return 1;
+}
 
-	/* --- saltos (apenas um salto por movimento, por enquanto) --- */
-	// TODO: implementar mutiplos saltos
+/* movimento sugerido de fora (hash, killer): precisa ser do lado a jogar,
+   legal aqui e um dos que o gerador produziria */
+static int game_picker_usable (const Game* game, Move mv) {
+	if ( mv == MOVE_NONE || move_side (mv) != game->to_move || game_is_legal_move (game, mv) != 1 )
+		return 0;
+#if !GAME_JUMP_PREFIXES
+	if ( move_type (mv) == MOVE_JUMP && !game_jump_is_maximal (game, mv) )
+		return 0;
+#endif
+	return 1;
+}
 
-	int neigh_mid[GRAPH_MAX_NEIGHBORS];
-	int deg_mid = 0;
+void game_picker_init (MovePicker* mp, const Game* game, Move hash_move, const Move killers[],
+					   const int history[], Move moves[], int max_moves, GameJumpTable* jumps) {
+	mp->game = game;
+	mp->stage = PICK_HASH;
+	mp->hash_move = hash_move;
+	mp->history = history;
+	mp->moves = moves;
+	mp->max_moves = max_moves;
+	mp->jumps = jumps;
+	mp->count = 0;
+	mp->index = 0;
+	mp->error = 0;
+
+	for ( int k = 0; k < GAME_MAX_KILLERS; k++ ) {
+		mp->killers[k] = killers ? killers[k] : MOVE_NONE;
+
+		/* killer repetido seria entregue duas vezes */
+		for ( int j = 0; j < k; j++ ) {
+			if ( mp->killers[k] == mp->killers[j] )
+				mp->killers[k] = MOVE_NONE;
+		}
+	}
+}
 
-	for ( int i = 0; i < deg; i++ ) {
-		int mid = neigh[i];
+/* 1 se mv ja foi entregue por um estagio anterior (hash ou killer) */
+static int game_picker_already_tried (const MovePicker* mp, Move mv, int with_killers) {
+	if ( mv == mp->hash_move )
+		return 1;
 
-		if ( game->cell_at[mid] != CELL_DOG )
-			continue;
+	if ( with_killers ) {
+		for ( int k = 0; k < GAME_MAX_KILLERS; k++ ) {
+			if ( mv == mp->killers[k] )
+				return 1;
+		}
+	}
 
-		if ( graph_get_neighbors (&game->g, mid, neigh_mid, &deg_mid) != 0 )
-			continue;
+	return 0;
+}
 
-		for ( int j = 0; j < deg_mid; j++ ) {
-			if ( *out_count >= max_moves )
-				return 0;
+/* nota de ordenacao: caes capturados para capturas, historia para simples */
+static int game_picker_score (const MovePicker* mp, Move mv) {
+	if ( move_type (mv) == MOVE_JUMP )
+		return bb_popcount (move_captured (mv));
 
-			Move mv;
-			mv.side = CELL_JAGUAR;
-			mv.type = MOVE_JUMP;
-			mv.path_len = 2;
-			mv.path[0] = jpos;
-			mv.path[1] = neigh_mid[j];
+	return mp->history[move_from (mv) * GRAPH_MAX_VERTICES + move_to (mv)];
+}
 
-			if ( game_is_legal_move (game, &mv) == 1 )
-				moves[(*out_count)++] = mv;
+/* traz para mp->index o restante de maior nota (selecao parcial: num no
+   de corte so os primeiros movimentos chegam a ser ordenados) */
+static void game_picker_select (MovePicker* mp) {
+	int best = mp->index;
+	int best_score = game_picker_score (mp, mp->moves[best]);
+
+	for ( int i = mp->index + 1; i < mp->count; i++ ) {
+		int sc = game_picker_score (mp, mp->moves[i]);
+		if ( sc > best_score ) {
+			best = i;
+			best_score = sc;
 		}
 	}
 
-	return 0;
+	Move tmp = mp->moves[mp->index];
+	mp->moves[mp->index] = mp->moves[best];
+	mp->moves[best] = tmp;
+}
+
+Move game_picker_next (MovePicker* mp) {
+	const Game* game = mp->game;
+
+	while ( 1 ) {
+		switch ( mp->stage ) {
+			case PICK_HASH:
+				mp->stage = PICK_CAPTURES_GEN;
+				if ( game_picker_usable (game, mp->hash_move) )
+					return mp->hash_move;
+
+				mp->hash_move = MOVE_NONE;
+				break;
+
+			case PICK_CAPTURES_GEN:
+				if ( game_generate_captures (game, mp->moves, mp->max_moves, &mp->count, mp->jumps) != 0 ) {
+					mp->error = 1;
+					mp->stage = PICK_DONE;
+					return MOVE_NONE;
+				}
+				mp->index = 0;
+				mp->stage = PICK_CAPTURES;
+				break;
+
+			case PICK_CAPTURES:
+				while ( mp->index < mp->count ) {
+					game_picker_select (mp);
+					Move mv = mp->moves[mp->index++];
+					if ( !game_picker_already_tried (mp, mv, 0) )
+						return mv;
+				}
+				mp->index = 0;
+				mp->stage = PICK_KILLERS;
+				break;
+
+			case PICK_KILLERS:
+				while ( mp->index < GAME_MAX_KILLERS ) {
+					Move mv = mp->killers[mp->index++];
+
+					/* killers sao movimentos simples; capturas ja sairam acima */
+					if ( mv != mp->hash_move && move_type (mv) == MOVE_SIMPLE && game_picker_usable (game, mv) )
+						return mv;
+				}
+				mp->stage = PICK_QUIETS_GEN;
+				break;
+
+			case PICK_QUIETS_GEN:
+				if ( game_generate_quiets (game, mp->moves, mp->max_moves, &mp->count) != 0 ) {
+					mp->error = 1;
+					mp->stage = PICK_DONE;
+					return MOVE_NONE;
+				}
+				mp->index = 0;
+				mp->stage = PICK_QUIETS;
+				break;
+
+			case PICK_QUIETS:
+				while ( mp->index < mp->count ) {
+					if ( mp->history )
+						game_picker_select (mp);
+					Move mv = mp->moves[mp->index++];
+					if ( !game_picker_already_tried (mp, mv, 1) )
+						return mv;
+				}
+				mp->stage = PICK_DONE;
+				break;
+
+			default:
+				return MOVE_NONE;
+		}
+	}
 }
@@ -46,8 +46,92 @@ typedef enum {
 	MOVE_JUMP
 } MoveType;
 
+#define GAME_MAX_PATH 16 /* vertices em um caminho de saltos (mesmo limite do controlador) */
+
+/* capacidade de uma lista de movimentos avulsa (raiz, MCTS, tabelas).
+   No mapa padrao o pior caso medido eh de 541 cadeias maximais da onca
+   (14 caes) mais ate 8 passos; listas menores que o necessario fazem os
+   geradores falharem em vez de truncar */
+#define GAME_MAX_MOVES 1024
+
+#define GAME_MAX_KILLERS 2 /* movimentos "killer" aceitos pelo MovePicker */
+
+#define GAME_HISTORY_SIZE (GRAPH_MAX_VERTICES * GRAPH_MAX_VERTICES) /* tabela de historia [from][to] */
+
+#ifndef GAME_JAGUAR_WIN_DOGS
+#define GAME_JAGUAR_WIN_DOGS 9 /* a onca vence quando restam ate este numero de caes */
+#endif
+
+/* estados (destino, capturados) lembrados ao gerar cadeias; o pior caso
+   medido no mapa padrao eh de 3460 estados distintos (14 caes) */
+#define GAME_MAX_JUMP_STATES 8192
+
+/* 0: gera apenas as cadeias maximais (a onca sempre captura tudo que pode);
+   1: gera toda cadeia de saltos, inclusive as que param antes do fim (um
+   lance por estado: passa de GAME_MAX_MOVES nas posicoes mais densas) */
+#ifndef GAME_JUMP_PREFIXES
+#define GAME_JUMP_PREFIXES 0
+#endif
+
+/* ---------------- Move compactado ---------------- */
+
+#define MOVE_FROM_SHIFT 0
+#define MOVE_TO_SHIFT 6
+#define MOVE_TYPE_SHIFT 12
+#define MOVE_SIDE_SHIFT 14
+#define MOVE_CAPT_SHIFT 16
+
+#define MOVE_MAX_CAPT_VERTICES (64 - MOVE_CAPT_SHIFT) /* vertices representaveis em captured */
+
 /**
- * @brief Representa um movimento no grafo.
+ * @brief Movimento compactado em uma palavra de 64 bits.
+ *
+ * bits  0..5  : vertice de origem
+ * bits  6..11 : vertice de destino
+ * bits 12..13 : MoveType
+ * bits 14..15 : lado que joga (CellContent)
+ * bits 16..63 : caes capturados (bit 16 + v = cao do vertice v), so em MOVE_JUMP
+ *
+ * A palavra basta para aplicar e desfazer qualquer movimento, inclusive
+ * saltos multiplos: a onca sai da origem, chega no destino e os caes
+ * marcados saem do tabuleiro. A ordem dos saltos so importa para o
+ * controlador e eh reconstruida na fronteira (game_move_to_path).
+ * MOVE_NONE (0) nunca eh um movimento valido.
+ */
+typedef uint64_t Move;
+
+#define MOVE_NONE ((Move)0)
+
+static inline Move move_make (CellContent side, MoveType type, int from, int to, Bitboard captured) {
+	return ((Move)from << MOVE_FROM_SHIFT) | ((Move)to << MOVE_TO_SHIFT) |
+		   ((Move)type << MOVE_TYPE_SHIFT) | ((Move)side << MOVE_SIDE_SHIFT) |
+		   (captured << MOVE_CAPT_SHIFT);
+}
+
+static inline int move_from (Move mv) {
+	return (int)((mv >> MOVE_FROM_SHIFT) & 63);
+}
+
+static inline int move_to (Move mv) {
+	return (int)((mv >> MOVE_TO_SHIFT) & 63);
+}
+
+static inline MoveType move_type (Move mv) {
+	return (MoveType)((mv >> MOVE_TYPE_SHIFT) & 3);
+}
+
+static inline CellContent move_side (Move mv) {
+	return (CellContent)((mv >> MOVE_SIDE_SHIFT) & 3);
+}
+
+static inline Bitboard move_captured (Move mv) {
+	return mv >> MOVE_CAPT_SHIFT;
+}
+
+/**
+ * @brief Movimento por extenso, como o controlador o descreve.
+ *
+ * Usado apenas na fronteira com o controlador/stdin.
  *
  * path[0] = vertice origem
  * path[1..] = vertices destino
@@ -56,38 +140,138 @@ typedef struct {
 	MoveType type;	  /**< MOVE_SIMPLE ou MOVE_JUMP        */
 	CellContent side; /**< Lado que joga (cao ou onca)      */
 
-	int path[GRAPH_MAX_VERTICES]; /**< Sequencia de vertices             */
-	int path_len;				  /**< Numero de vertices utilizados     */
-} Move;
+	int path[GAME_MAX_PATH]; /**< Sequencia de vertices             */
+	int path_len;			 /**< Numero de vertices utilizados     */
+} MovePath;
 
 /**
  * @brief Estrutura que representa o estado do jogo.
  *
  * Contem:
- *   - grafo interno g (topologia fixa do tabuleiro)
- *   - ocupacao de cada vertice (cell_at[])
+ *   - ponteiro para o grafo do tabuleiro (topologia fixa, compartilhada)
+ *   - ocupacao dos caes como bitboard (bit v = cao no vertice v)
  *   - posicao da onca
- *   - numero de caes
  *   - lado que ira jogar
+ *   - vencedor da posicao (mantido pelas funcoes que alteram o estado)
+ *   - chave Zobrist da posicao (idem)
+ *
+ * O grafo eh construido uma unica vez por game_init e nunca eh alterado
+ * depois; copiar um Game copia apenas a ocupacao e o lado a jogar.
+ * O numero de caes e o conteudo de cada casa sao derivados das mascaras
+ * (game_num_dogs, game_cell_at).
  */
 typedef struct {
-	Graph g; /**< Grafo interno (topologia)       */
+	const Graph* g; /**< Grafo do tabuleiro (somente leitura) */
 
-	CellContent cell_at[GRAPH_MAX_VERTICES]; /**< Ocupacao de cada vertice        */
-	int jaguar_pos;							 /**< ID do vertice onde esta a onca  */
-	int num_dogs;							 /**< Numero de caes no tabuleiro     */
+	Bitboard dogs;	/**< Vertices ocupados por caes      */
+	int jaguar_pos; /**< ID do vertice onde esta a onca  */
 
 	CellContent to_move; /**< Lado que joga agora             */
+	CellContent winner;	 /**< Vencedor, ou CELL_EMPTY          */
+
+	uint64_t key;		 /**< Chave Zobrist (pecas + lado a jogar) */
+	uint64_t mirror_key; /**< Chave da posicao espelhada (Graph.mirror) */
+
+	int psq; /**< Soma das tabelas por vertice (game_compute_psq) */
 } Game;
 
+/**
+ * @brief Mascara do vertice da onca (vazia se nao houver onca).
+ */
+static inline Bitboard game_jaguar_mask (const Game* game) {
+	return game->jaguar_pos >= 0 ? BB_BIT (game->jaguar_pos) : BB_EMPTY;
+}
+
+/**
+ * @brief Mascara dos vertices vazios do tabuleiro.
+ */
+static inline Bitboard game_empty_mask (const Game* game) {
+	return game->g->all & ~(game->dogs | game_jaguar_mask (game));
+}
+
+/**
+ * @brief Calcula o vencedor da posicao so com operacoes de mascara.
+ *
+ * A onca vence com GAME_JAGUAR_WIN_DOGS caes ou menos. Ela esta presa
+ * quando nao tem vizinho vazio; nesse caso todo vizinho eh cao, entao
+ * basta que nenhum destino de salto esteja vazio.
+ *
+ * @return CELL_JAGUAR, CELL_DOG ou CELL_EMPTY (sem vencedor).
+ */
+static inline CellContent game_compute_winner (const Game* game) {
+	if ( bb_popcount (game->dogs) <= GAME_JAGUAR_WIN_DOGS )
+		return CELL_JAGUAR;
+
+	if ( game->jaguar_pos < 0 )
+		return CELL_DOG;
+
+	const Vertex* v = &game->g->v[game->jaguar_pos];
+	Bitboard empty = game_empty_mask (game);
+
+	if ( !((v->adj | v->jump_land) & empty) )
+		return CELL_DOG;
+
+	return CELL_EMPTY;
+}
+
+/**
+ * @brief Numero de caes no tabuleiro.
+ */
+static inline int game_num_dogs (const Game* game) {
+	return bb_popcount (game->dogs);
+}
+
+/**
+ * @brief Conteudo da casa vid (CELL_EMPTY, CELL_DOG ou CELL_JAGUAR).
+ */
+static inline CellContent game_cell_at (const Game* game, int vid) {
+	if ( vid == game->jaguar_pos )
+		return CELL_JAGUAR;
+	return bb_test (game->dogs, vid) ? CELL_DOG : CELL_EMPTY;
+}
+
+/**
+ * @brief Registro para desfazer um movimento feito com game_make_move.
+ *
+ * Guarda apenas o que o movimento destroi: os caes capturados, a posicao
+ * anterior da onca, o lado que jogava, o vencedor, as chaves e a soma
+ * das tabelas por vertice anteriores.
+ */
+typedef struct {
+	Bitboard captured;	 /**< Caes removidos pelo movimento     */
+	int jaguar_pos;		 /**< Posicao da onca antes do movimento */
+	CellContent to_move; /**< Lado a jogar antes do movimento   */
+	CellContent winner;	 /**< Vencedor antes do movimento       */
+	uint64_t key;		 /**< Chave Zobrist antes do movimento  */
+	uint64_t mirror_key; /**< Chave espelhada antes do movimento */
+	int psq;			 /**< Game.psq antes do movimento        */
+} GameUndo;
+
+/**
+ * @brief Memoria de trabalho para gerar as cadeias de saltos da onca.
+ *
+ * Estados (destino, capturados) ja expandidos, com uma lista por
+ * destino. Sao cerca de 80 KB: cada thread de busca mantem a sua e a
+ * passa aos geradores, em vez de montar uma na pilha a cada geracao.
+ * Nao precisa de inicializacao nem guarda nada entre uma geracao e outra.
+ */
+typedef struct {
+	Move visited[GAME_MAX_JUMP_STATES];
+	int16_t next_visited[GAME_MAX_JUMP_STATES];
+	int16_t first_visited[GRAPH_MAX_VERTICES]; /* -1: nenhum estado com este destino */
+} GameJumpTable;
+
 /**
  * @brief Inicializa o estado do jogo e cria o grafo interno.
  *
+ * Falha se o grafo tiver mais vertices do que Move consegue marcar
+ * como capturados (MOVE_MAX_CAPT_VERTICES).
+ *
  * Esta funcao:
- *   - construtor do grafo interno g (graph_create)
- *   - limpa todas as casas (cell_at[])
+ *   - constroi o grafo do tabuleiro (graph_create) na primeira chamada
+ *     e aponta game->g para ele
+ *   - limpa todas as casas (dogs = 0)
  *   - define jaguar_pos = -1
- *   - define num_dogs = 0
  *   - define to_move = CELL_JAGUAR por padrao
  *
  * @param game Ponteiro para estrutura Game.
@@ -112,9 +296,8 @@ int game_clear (Game* game);
  *   CTRL_EMPTY_CHAR  -> CELL_EMPTY
  *
  * Campos atualizados:
- *   - cell_at[]      (ocupacao de cada vertice)
+ *   - dogs           (mascara dos vertices com caes)
  *   - jaguar_pos     (vertice onde esta a onca)
- *   - num_dogs       (quantidade de caes)
  *   - to_move        (lado a jogar, baseado no parametro lado)
  *
  * @param game   Ponteiro para Game.
@@ -128,11 +311,14 @@ int game_from_controller_board (Game* game, const char* board, char lado);
 /**
  * @brief Verifica se um movimento eh legal segundo as regras.
  *
+ * Feita para validar movimentos vindos de fora (controlador, stdin);
+ * os movimentos de game_generate_moves ja sao legais por construcao.
+ *
  * @param game Estado atual.
  * @param mv Movimento a verificar.
  * @return 1 se legal, 0 se ilegal, <0 em erro.
  */
-int game_is_legal_move (const Game* game, const Move* mv);
+int game_is_legal_move (const Game* game, Move mv);
 
 /**
  * @brief Aplica um movimento ao estado do jogo.
@@ -143,18 +329,244 @@ int game_is_legal_move (const Game* game, const Move* mv);
  * @param mv Movimento.
  * @return 0 em sucesso, <0 em erro.
  */
-int game_apply_move (Game* game, const Move* mv);
+int game_apply_move (Game* game, Move mv);
+
+/**
+ * @brief Aplica um movimento no proprio estado, preenchendo o registro de desfazer.
+ *
+ * Assume que ja foi verificado como legal. Usado pela busca para andar
+ * na arvore sem copiar o Game a cada no.
+ *
+ * @param game Estado atual (modificado).
+ * @param mv Movimento.
+ * @param undo Saida com o necessario para game_unmake_move.
+ * @return 0 em sucesso, <0 em erro.
+ */
+int game_make_move (Game* game, Move mv, GameUndo* undo);
+
+/**
+ * @brief Desfaz um movimento feito com game_make_move.
+ *
+ * Deve ser chamado na ordem inversa das chamadas a game_make_move,
+ * com o mesmo movimento e o registro preenchido por ela.
+ *
+ * @param game Estado depois do movimento (restaurado ao anterior).
+ * @param mv Movimento desfeito.
+ * @param undo Registro preenchido por game_make_move.
+ */
+void game_unmake_move (Game* game, Move mv, const GameUndo* undo);
+
+/**
+ * @brief Passa a vez sem mexer nenhuma peca (lance nulo).
+ *
+ * Nao eh um lance das regras: serve a busca (poda por lance nulo), que
+ * pergunta se a posicao continua boa mesmo dando um lance ao adversario.
+ *
+ * @param game Estado atual (modificado).
+ * @param undo Saida com o necessario para game_unmake_null_move.
+ */
+void game_make_null_move (Game* game, GameUndo* undo);
+
+/**
+ * @brief Desfaz um lance nulo feito com game_make_null_move.
+ */
+void game_unmake_null_move (Game* game, const GameUndo* undo);
 
 /**
  * @brief Gera todos os movimentos legais para o lado atual.
  *
+ * Os movimentos saem legais por construcao, direto das mascaras de
+ * ocupacao e das tabelas do grafo (nao precisam de game_is_legal_move).
+ * Para a onca inclui os saltos multiplos: cada conjunto distinto de
+ * (destino, caes capturados) aparece uma unica vez, qualquer que seja a
+ * ordem das capturas. So as cadeias maximais sao geradas, a menos que
+ * GAME_JUMP_PREFIXES seja 1.
+ *
  * @param game Estado atual.
- * @param moves Vetor de saida.
+ * @param moves Vetor de saida (GAME_MAX_MOVES cobre o mapa padrao).
  * @param max_moves Tamanho maximo do vetor moves.
  * @param out_count Numero de movimentos gerados.
- * @return 0 em sucesso, <0 em erro.
+ * @param jumps Tabela de estados das cadeias (uma por thread).
+ * @return 0 em sucesso, <0 em erro (-1: moves[] ou a tabela de estados
+ *         das cadeias encheu; a lista fica incompleta).
  */
-int game_generate_moves (const Game* game, Move moves[], int max_moves, int* out_count);
+int game_generate_moves (const Game* game, Move moves[], int max_moves, int* out_count, GameJumpTable* jumps);
+
+/**
+ * @brief Gera apenas as capturas (cadeias de saltos da onca) do lado atual.
+ *
+ * Vazio quando os caes jogam. Mesmos parametros de game_generate_moves.
+ */
+int game_generate_captures (const Game* game, Move moves[], int max_moves, int* out_count, GameJumpTable* jumps);
+
+/**
+ * @brief Gera apenas os movimentos simples do lado atual.
+ *
+ * Mesmos parametros de game_generate_moves, sem a tabela de estados.
+ */
+int game_generate_quiets (const Game* game, Move moves[], int max_moves, int* out_count);
+
+/**
+ * @brief Casas onde a onca pousaria com um salto disponivel agora.
+ *
+ * Destinos vazios dos saltos da onca sobre caes adjacentes (primeiro
+ * salto de qualquer cadeia). Um cao que ocupe uma delas bloqueia aquele
+ * salto. Nao depende de quem joga.
+ */
+static inline Bitboard game_jaguar_threats (const Game* game) {
+	if ( game->jaguar_pos < 0 )
+		return BB_EMPTY;
+
+	const Vertex* v = &game->g->v[game->jaguar_pos];
+	Bitboard empty = game_empty_mask (game);
+	Bitboard threats = BB_EMPTY;
+
+	/* sem cao adjacente ou sem destino vazio nao ha salto */
+	if ( !(v->adj & game->dogs) || !(v->jump_land & empty) )
+		return BB_EMPTY;
+
+	for ( int k = 0; k < v->num_jumps; k++ ) {
+		if ( bb_test (game->dogs, v->jumps[k].over) && bb_test (empty, v->jumps[k].land) )
+			threats |= BB_BIT (v->jumps[k].land);
+	}
+
+	return threats;
+}
+
+/**
+ * @brief Estagios do MovePicker, na ordem em que sao percorridos.
+ */
+typedef enum {
+	PICK_HASH = 0,	   /* movimento sugerido pela tabela de transposicao */
+	PICK_CAPTURES_GEN, /* gera as capturas                               */
+	PICK_CAPTURES,	   /* entrega as capturas                            */
+	PICK_KILLERS,	   /* movimentos killer (simples)                    */
+	PICK_QUIETS_GEN,   /* gera os movimentos simples                     */
+	PICK_QUIETS,	   /* entrega os movimentos simples                  */
+	PICK_DONE
+} PickStage;
+
+/**
+ * @brief Gerador preguicoso de movimentos, em estagios.
+ *
+ * Entrega o movimento de hash, depois as capturas (mais caes capturados
+ * primeiro), depois os killers e por fim os movimentos simples, em ordem
+ * decrescente na tabela de historia quando ha uma. Cada estagio so eh
+ * gerado quando o anterior acaba, e a ordenacao eh feita por selecao a
+ * cada pedido, entao um corte beta no primeiro movimento evita gerar e
+ * ordenar o resto. Hash e killers sao conferidos com game_is_legal_move
+ * e nao se repetem nos estagios seguintes.
+ */
+typedef struct {
+	const Game* game;
+	PickStage stage;
+
+	Move hash_move;
+	Move killers[GAME_MAX_KILLERS];
+	const int* history; /* GAME_HISTORY_SIZE notas do lado a jogar, ou NULL */
+
+	Move* moves;		  /* estagio gerado atual, no espaco dado por quem chamou */
+	int max_moves;		  /* capacidade de moves[] */
+	GameJumpTable* jumps; /* tabela de estados das cadeias */
+	int count;
+	int index;
+	int error; /* um gerador falhou: a lista entregue esta incompleta */
+} MovePicker;
+
+/**
+ * @brief Prepara o gerador em estagios para o estado game.
+ *
+ * @param mp        Gerador.
+ * @param game      Estado (nao pode mudar enquanto o gerador for usado).
+ * @param hash_move Movimento a tentar primeiro, ou MOVE_NONE.
+ * @param killers   Vetor com GAME_MAX_KILLERS movimentos (ou MOVE_NONE), ou NULL.
+ * @param history   Notas dos movimentos simples do lado a jogar, indexadas
+ *                  por from * GRAPH_MAX_VERTICES + to, ou NULL (ordem de geracao).
+ * @param moves     Espaco para a lista de um estagio por vez; so o
+ *                  tamanho do estagio gerado eh usado (mp->count).
+ * @param max_moves Capacidade de moves[].
+ * @param jumps     Tabela de estados das cadeias (uma por thread).
+ */
+void game_picker_init (MovePicker* mp, const Game* game, Move hash_move, const Move killers[],
+					   const int history[], Move moves[], int max_moves, GameJumpTable* jumps);
+
+/**
+ * @brief Proximo movimento do gerador.
+ *
+ * Se a geracao de um estagio falhar (lista cheia), o gerador para e marca
+ * mp->error; quem recebe MOVE_NONE precisa conferir esse campo antes de
+ * tratar a posicao como sem lances.
+ *
+ * @return Movimento legal, ou MOVE_NONE quando nao ha mais movimentos.
+ */
+Move game_picker_next (MovePicker* mp);
+
+/**
+ * @brief Calcula a chave Zobrist da posicao do zero.
+ *
+ * XOR de um numero aleatorio fixo por (peca, vertice), mais um numero
+ * quando os caes jogam. Game.key eh mantida incrementalmente por
+ * game_make_move/game_unmake_move; esta funcao serve para montar o
+ * estado inicial e para conferir a versao incremental.
+ *
+ * @param game Estado atual.
+ * @return Chave de 64 bits.
+ */
+uint64_t game_compute_key (const Game* game);
+
+/**
+ * @brief Soma das tabelas por vertice (onca e caes) da posicao, do zero.
+ *
+ * As tabelas saem do grafo em game_init (grau, saltos, de quantos lados
+ * um cao pode ser saltado) e valem pontos para a onca. Game.psq eh
+ * mantida por game_make_move/game_unmake_move; esta funcao monta o
+ * estado inicial e confere a versao incremental.
+ */
+int game_compute_psq (const Game* game);
+
+/**
+ * @brief Chave Zobrist da posicao espelhada (Graph.mirror), do zero.
+ *
+ * Game.mirror_key eh mantida junto com Game.key; as duas so coincidem em
+ * posicoes simetricas.
+ */
+uint64_t game_compute_mirror_key (const Game* game);
+
+/**
+ * @brief Imagem de um conjunto de vertices no espelho (8 consultas a tabela).
+ *
+ * So vale depois de game_init.
+ */
+Bitboard game_mirror_mask (Bitboard set);
+
+/**
+ * @brief Diz se a forma canonica da posicao eh a espelhada.
+ *
+ * Canonica eh a orientacao com a onca no menor vertice entre jaguar_pos e
+ * o seu espelho; com a onca no eixo, a de menor mascara de caes. Tabelas
+ * (transposicao, livro, tablebase) guardam so a forma canonica.
+ */
+int game_mirror_needed (const Game* game);
+
+/**
+ * @brief Chave da forma canonica: igual para uma posicao e o seu espelho.
+ */
+static inline uint64_t game_canonical_key (const Game* game) {
+	return game_mirror_needed (game) ? game->mirror_key : game->key;
+}
+
+/**
+ * @brief Espelha um movimento (origem, destino e capturas).
+ *
+ * Lances guardados na forma canonica voltam a posicao real por aqui
+ * (o espelho eh a propria inversa).
+ */
+Move game_mirror_move (const Game* game, Move mv);
+
+/**
+ * @brief Troca a posicao pela espelhada (pecas e chaves).
+ */
+void game_mirror (Game* game);
 
 /**
  * @brief Verifica se ha vencedor.
@@ -169,7 +581,8 @@ int game_get_winner (const Game* game, CellContent* winner);
 /**
  * @brief Converte um movimento interno para a string usada pelo controlador.
  *
- * Gera strings como:
+ * game deve ser o estado ANTES do movimento (usado para reconstruir a
+ * ordem dos saltos). Gera strings como:
  *   "o m l0 c0 l1 c1"
  *   "o s n l0 c0 l1 c1 ... ln cn"
  *
@@ -180,7 +593,7 @@ int game_get_winner (const Game* game, CellContent* winner);
  *
  * @return 0 em sucesso, <0 em erro.
  */
-int game_move_to_controller (const Game* game, const Move* mv, char* buf, int bufsize);
+int game_move_to_controller (const Game* game, Move mv, char* buf, int bufsize);
 
 /**
  * @brief Converte jogada do controlador em Move interno.
@@ -198,22 +611,37 @@ int game_move_to_controller (const Game* game, const Move* mv, char* buf, int bu
 int game_move_from_controller (const Game* game, const char* jogada, Move* mv);
 
 /**
- * @brief Imprime o estado do jogo para debug.
+ * @brief Compacta um movimento por extenso em Move.
+ *
+ * Cada passo de um salto deve existir na tabela de saltos do grafo; o
+ * vertice saltado vira um bit de captured. Nao confere a ocupacao
+ * (use game_is_legal_move para isso).
+ *
+ * @param game Estado atual do jogo.
+ * @param path Movimento por extenso.
+ * @param mv   Saida com o movimento compactado.
+ * @return 0 em sucesso, <0 se o caminho nao for geometricamente valido.
  */
-void game_print (const Game* game);
-
-void game_print_board (const Game* game);
+int game_move_from_path (const Game* game, const MovePath* path, Move* mv);
 
 /**
- * @brief Retorna o vertice intermediario entre dois vertices usados em salto.
+ * @brief Expande um Move no caminho por extenso aceito pelo controlador.
  *
- * @param g        Ponteiro para o grafo.
- * @param from_vid Indice do vertice de origem.
- * @param to_vid   Indice do vertice de destino.
+ * Para saltos, procura uma ordem de capturas que leve da origem ao
+ * destino passando por todos os caes de captured.
  *
- * @return Indice do vertice intermediario,
- *         ou -1 se nao existir ou se nao for um salto valido.
+ * @param game Estado ANTES do movimento.
+ * @param mv   Movimento compactado.
+ * @param path Saida com o caminho.
+ * @return 0 em sucesso, <0 se nao existir caminho valido.
+ */
+int game_move_to_path (const Game* game, Move mv, MovePath* path);
+
+/**
+ * @brief Imprime o estado do jogo para debug.
  */
-int graph_get_mid_jump (const Graph* g, int from_vid, int to_vid);
+void game_print (const Game* game);
+
+void game_print_board (const Game* game);
 
 #endif /* GAME_H */
@@ -11,6 +11,14 @@ typedef struct {
 	int** vertices; /* mapeia (i,j) -> id do vertice ou -1 */
 } Map;
 
+/* direcoes (dr, dc) no mapa ASCII e caracteres esperados de aresta nessa direcao */
+static const int dir_dr[GRAPH_NUM_DIRS] = {0, 0, 1, -1, 1, 1, -1, -1};
+static const int dir_dc[GRAPH_NUM_DIRS] = {1, -1, 0, 0, 1, -1, 1, -1};
+static const char dir_edge[GRAPH_NUM_DIRS] = {'-', '-', '|', '|', '\\', '/', '/', '\\'};
+
+/* direcao oposta a cada direcao acima */
+static const int dir_opposite[GRAPH_NUM_DIRS] = {1, 0, 3, 2, 7, 6, 5, 4};
+
 /**
  * @brief Inicializa um vertice do grafo.
  *
@@ -28,6 +36,14 @@ int vertex_init (Vertex* v, int row, int col) {
 	v->c.row = row;
 	v->c.col = col;
 	v->degree = 0;
+	v->adj = BB_EMPTY;
+	v->num_jumps = 0;
+	v->jump_land = BB_EMPTY;
+
+	for ( int d = 0; d < GRAPH_NUM_DIRS; d++ ) {
+		v->step[d] = -1;
+		v->land[d] = -1;
+	}
 
 	for ( int k = 0; k < GRAPH_MAX_NEIGHBORS; k++ )
 		v->neighbors[k] = -1;
@@ -352,27 +368,23 @@ int explorer (Graph* g, Map* m, int i, int j, int vertex_id) {
 		/* nao retorno erro duro aqui, so aviso */
 	}
 
-	/* direcoes (dr, dc) e caracteres esperados de aresta nessa direcao */
-	int dr[8] = {0, 0, 1, -1, 1, 1, -1, -1};
-	int dc[8] = {1, -1, 0, 0, 1, -1, 1, -1};
-	char edge[8] = {'-', '-', '|', '|', '\\', '/', '/', '\\'};
 	int neighbor_id;
 
-	for ( int dir = 0; dir < 8; dir++ ) {
-		int r = i + dr[dir];
-		int c = j + dc[dir];
+	for ( int dir = 0; dir < GRAPH_NUM_DIRS; dir++ ) {
+		int r = i + dir_dr[dir];
+		int c = j + dir_dc[dir];
 
 		/* checa se a primeira posicao na direcao contem o caractere da aresta */
 		if ( r < 0 || r >= m->rows || c < 0 || c >= m->cols )
 			continue;
 
-		if ( m->data[r][c] != edge[dir] )
+		if ( m->data[r][c] != dir_edge[dir] )
 			continue;
 
 		/* caminha pela aresta ate achar outro vertice ou algo invalido */
 		while ( 1 ) {
-			r += dr[dir];
-			c += dc[dir];
+			r += dir_dr[dir];
+			c += dir_dc[dir];
 
 			if ( r < 0 || r >= m->rows || c < 0 || c >= m->cols )
 				break;
@@ -389,6 +401,10 @@ int explorer (Graph* g, Map* m, int i, int j, int vertex_id) {
 				Vertex* v = &g->v[vertex_id];
 				Vertex* vn = &g->v[neighbor_id];
 
+				/* a aresta segue a direcao dir; no vizinho, a direcao oposta */
+				v->step[dir] = (signed char)neighbor_id;
+				vn->step[dir_opposite[dir]] = (signed char)vertex_id;
+
 				/* adiciona neighbor_id em v->neighbors se ainda nao estiver */
 				int exists = 0;
 				for ( int k = 0; k < v->degree; k++ ) {
@@ -436,7 +452,7 @@ int explorer (Graph* g, Map* m, int i, int j, int vertex_id) {
 			}
 
 			/* se nao eh nem aresta nem vertice, para */
-			if ( m->data[r][c] != edge[dir] )
+			if ( m->data[r][c] != dir_edge[dir] )
 				break;
 		}
 	}
@@ -444,6 +460,57 @@ int explorer (Graph* g, Map* m, int i, int j, int vertex_id) {
 	return 0;
 }
 
+/* espelho: vertice na mesma linha com a coluna refletida entre a menor e
+   a maior coluna do mapa. So vale se levar vizinhos em vizinhos e saltos
+   em saltos; senao fica a identidade */
+static void graph_build_mirror (Graph* g) {
+	int cmin = 0, cmax = 0;
+
+	for ( int v = 0; v < g->num_vertices; v++ ) {
+		if ( v == 0 || g->v[v].c.col < cmin )
+			cmin = g->v[v].c.col;
+		if ( v == 0 || g->v[v].c.col > cmax )
+			cmax = g->v[v].c.col;
+	}
+
+	g->symmetric = 1;
+	for ( int v = 0; v < g->num_vertices && g->symmetric; v++ ) {
+		int m = graph_get_index (g, g->v[v].c.row, cmin + cmax - g->v[v].c.col);
+		if ( m < 0 )
+			g->symmetric = 0;
+		else
+			g->mirror[v] = (signed char)m;
+	}
+
+	for ( int v = 0; v < g->num_vertices && g->symmetric; v++ ) {
+		const Vertex* a = &g->v[v];
+		const Vertex* b = &g->v[(int)g->mirror[v]];
+		Bitboard adj = BB_EMPTY;
+		Bitboard land = BB_EMPTY;
+
+		for ( int u = 0; u < g->num_vertices; u++ ) {
+			if ( bb_test (a->adj, u) )
+				adj |= BB_BIT (g->mirror[u]);
+			if ( bb_test (a->jump_land, u) )
+				land |= BB_BIT (g->mirror[u]);
+		}
+
+		if ( adj != b->adj || land != b->jump_land )
+			g->symmetric = 0;
+	}
+
+	if ( !g->symmetric ) {
+		for ( int v = 0; v < g->num_vertices; v++ )
+			g->mirror[v] = (signed char)v;
+	}
+
+	g->mirror_canon = BB_EMPTY;
+	for ( int v = 0; v < g->num_vertices; v++ ) {
+		if ( v <= g->mirror[v] )
+			g->mirror_canon |= BB_BIT (v);
+	}
+}
+
 /**
  * Constroi o grafo completo a partir de um arquivo de mapa.
  *
@@ -517,6 +584,37 @@ int graph_create (Graph* g, const char* map_path) {
 		}
 	}
 
+	/* mascaras de vizinhanca para consultas em bitboard */
+	g->all = BB_EMPTY;
+	for ( int v = 0; v < g->num_vertices; v++ ) {
+		g->all |= BB_BIT (v);
+		for ( int k = 0; k < g->v[v].degree; k++ )
+			g->v[v].adj |= BB_BIT (g->v[v].neighbors[k]);
+	}
+
+	/* saltos: dois passos seguidos na mesma direcao (linha reta no mapa) */
+	for ( int v = 0; v < g->num_vertices; v++ ) {
+		Vertex* vert = &g->v[v];
+
+		for ( int d = 0; d < GRAPH_NUM_DIRS; d++ ) {
+			int over = vert->step[d];
+			if ( over < 0 )
+				continue;
+
+			int land = g->v[over].step[d];
+			if ( land < 0 )
+				continue;
+
+			vert->land[d] = (signed char)land;
+			vert->jumps[vert->num_jumps].over = (signed char)over;
+			vert->jumps[vert->num_jumps].land = (signed char)land;
+			vert->num_jumps++;
+			vert->jump_land |= BB_BIT (land);
+		}
+	}
+
+	graph_build_mirror (g);
+
 	/* libera mapa */
 	status = destroy_map (&m);
 	if ( status != 0 ) {
@@ -625,3 +723,32 @@ int graph_degree (const Graph* g, int vid) {
 
 	return g->v[vid].degree;
 }
+
+int graph_get_mid_jump (const Graph* g, int from_vid, int to_vid) {
+	if ( from_vid < 0 || from_vid >= g->num_vertices )
+		return -1;
+
+	const Vertex* v = &g->v[from_vid];
+
+	for ( int k = 0; k < v->num_jumps; k++ ) {
+		if ( v->jumps[k].land == to_vid )
+			return v->jumps[k].over;
+	}
+
+	return -1;
+}
+
+uint64_t graph_hash (const Graph* g) {
+	uint64_t h = 0xcbf29ce484222325ULL; /* FNV-1a sobre as mascaras */
+
+	for ( int v = 0; v < g->num_vertices; v++ ) {
+		uint64_t words[2] = { g->v[v].adj, g->v[v].jump_land };
+		for ( int w = 0; w < 2; w++ ) {
+			for ( int b = 0; b < 8; b++ ) {
+				h ^= (words[w] >> (8 * b)) & 0xff;
+				h *= 0x100000001b3ULL;
+			}
+		}
+	}
+	return h;
+}
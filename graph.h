@@ -1,8 +1,11 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include "bitboard.h"
+
 #define GRAPH_MAX_VERTICES 64
 #define GRAPH_MAX_NEIGHBORS 8
+#define GRAPH_NUM_DIRS 8 /* direcoes de caminhada no mapa ASCII (4 retas + 4 diagonais) */
 
 /* ---------------- Structs ---------------- */
 
@@ -11,15 +14,39 @@ typedef struct {
 	int col;
 } Coordinate;
 
+/**
+ * @brief Salto em linha reta a partir de um vertice.
+ *
+ * over eh o vizinho saltado e land o vertice seguinte na mesma direcao.
+ */
+typedef struct {
+	signed char over;
+	signed char land;
+} Jump;
+
 typedef struct {
 	Coordinate c;
 	int neighbors[GRAPH_MAX_NEIGHBORS]; /* IDs dos vizinhos */
 	int degree;							/* numero de vizinhos */
+	Bitboard adj;						/* mascara dos vizinhos */
+
+	signed char step[GRAPH_NUM_DIRS]; /* vizinho em cada direcao ou -1 */
+	signed char land[GRAPH_NUM_DIRS]; /* destino do salto em cada direcao ou -1 */
+	Jump jumps[GRAPH_NUM_DIRS];		  /* saltos possiveis (compactados) */
+	int num_jumps;					  /* numero de entradas em jumps[] */
+	Bitboard jump_land;				  /* mascara dos destinos de salto */
 } Vertex;
 
 typedef struct {
 	Vertex v[GRAPH_MAX_VERTICES];
 	int num_vertices;
+	Bitboard all; /* mascara com todos os vertices do grafo */
+
+	/* espelho esquerda-direita (coluna refletida no eixo do mapa). Se o
+	   mapa nao for simetrico, mirror eh a identidade e symmetric = 0 */
+	signed char mirror[GRAPH_MAX_VERTICES];
+	Bitboard mirror_canon; /* vertices v com v <= mirror[v] (onca na forma canonica) */
+	int symmetric;
 } Graph;
 
 /* ---------------- Funcoes publicas ---------------- */
@@ -28,6 +55,12 @@ typedef struct {
  * @brief Carrega o mapa do arquivo e constroi o grafo completo.
  *
  * Inicializa o Graph, carrega o Map, cria vertices e adjacencias.
+ * Ao final preenche as mascaras de vizinhanca (Vertex.adj) e de
+ * vertices validos (Graph.all), usadas pelas consultas em bitboard,
+ * e as tabelas de direcao: para cada vertice e direcao, o vizinho
+ * (step), o vertice saltado e o destino do salto (land / jumps[],
+ * jump_land). Por ultimo, a permutacao do espelho (Graph.mirror), tirada
+ * das coordenadas e conferida contra vizinhancas e saltos.
  * O usuario so precisa chamar esta funcao para ter um grafo pronto.
  */
 int graph_create (Graph* g, const char* map_path);
@@ -86,6 +119,21 @@ int graph_get_neighbors (const Graph* g, int vid, int out_neighbors[], int* degr
 
 void print_graph (const Graph* g);
 
+/**
+ * @brief Retorna o vertice intermediario entre dois vertices usados em salto.
+ *
+ * Consulta a tabela de saltos montada por graph_create; nao faz aritmetica
+ * de coordenadas nem busca no grafo.
+ *
+ * @param g        Ponteiro para o grafo.
+ * @param from_vid Indice do vertice de origem.
+ * @param to_vid   Indice do vertice de destino.
+ *
+ * @return Indice do vertice intermediario,
+ *         ou -1 se nao existir ou se nao for um salto valido.
+ */
+int graph_get_mid_jump (const Graph* g, int from_vid, int to_vid);
+
 /**
  * @brief Retorna o grau (numero de vizinhos) de um vertice.
  *
@@ -95,4 +143,15 @@ void print_graph (const Graph* g);
  */
 int graph_degree (const Graph* g, int vid);
 
+/**
+ * @brief Resumo (FNV-1a) das vizinhancas e dos saltos do grafo.
+ *
+ * Arquivos gerados offline (tabela de finais, livro de aberturas) gravam
+ * este valor e recusam ser carregados num tabuleiro diferente.
+ *
+ * @param g Ponteiro para o grafo.
+ * @return Hash de 64 bits.
+ */
+uint64_t graph_hash (const Graph* g);
+
 #endif /* GRAPH_H */
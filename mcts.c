@@ -0,0 +1,620 @@
+#define _POSIX_C_SOURCE 200809L /* clock_gettime */
+
+#include "mcts.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MCTS_UNUSED UINT32_MAX /* compactacao: no fora da subarvore mantida */
+
+/* estado de expansao de um no */
+enum {
+	MCTS_LEAF = 0,	/* sem filhos ainda                        */
+	MCTS_EXPANDING, /* uma thread esta gerando os filhos       */
+	MCTS_EXPANDED	/* first/count valem (publicados por state) */
+};
+
+typedef struct {
+	Move move;		/* lance que leva a este no (MOVE_NONE na raiz) */
+	uint32_t first; /* primeiro filho no pool; os filhos sao contiguos */
+	int32_t count;	/* numero de filhos */
+
+	_Atomic int32_t state;
+	_Atomic int32_t visits; /* inclui as perdas virtuais em andamento */
+	_Atomic int64_t reward; /* em meios pontos, para quem fez move */
+} MctsNode;
+
+/* arvore: pool de nos alocado uma vez; o no 0 eh a raiz */
+typedef struct {
+	MctsNode* nodes;
+	uint32_t* forward; /* rascunho da compactacao (novo indice de cada no) */
+	uint32_t capacity;
+	_Atomic uint32_t next; /* proximo no livre (pode passar de capacity) */
+	int mb;
+
+	Game root; /* posicao do no 0 */
+	int has_root;
+} MctsTree;
+
+typedef struct {
+	MctsTree* tree;
+	const Game* root;
+	const AiConfig* cfg;
+
+	atomic_int* stop;
+	_Atomic long long* playouts; /* de todas as threads */
+	long long limit;			 /* playouts pedidos, ou 0 */
+	long long deadline_ms;		 /* instante limite, ou 0 */
+
+	uint64_t rng;
+	int failed;			/* game_generate_moves falhou: a busca devolve erro */
+	GameJumpTable jumps; /* estados das cadeias de saltos desta thread */
+	pthread_t thread;
+} MctsWorker;
+
+/* pool mantido entre buscas para reaproveitar a subarvore; uma segunda
+   busca simultanea usa um pool proprio, descartado no fim */
+static MctsTree mcts_tree;
+static int mcts_busy = 0;
+static pthread_mutex_t mcts_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static long long mcts_now_ms (void) {
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* xorshift64 */
+static uint64_t mcts_random (uint64_t* state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+static CellContent mcts_opposite (CellContent s) {
+	return s == CELL_JAGUAR ? CELL_DOG : CELL_JAGUAR;
+}
+
+/* ---------------- Pool de nos ---------------- */
+
+static void mcts_tree_destroy (MctsTree* t) {
+	free (t->nodes);
+	free (t->forward);
+	memset (t, 0, sizeof *t);
+}
+
+static int mcts_tree_create (MctsTree* t, int mb) {
+	size_t bytes = (size_t)(mb > 0 ? mb : 1) << 20;
+	size_t capacity = bytes / (sizeof (MctsNode) + sizeof (uint32_t));
+
+	if ( capacity > MCTS_UNUSED - 1 )
+		capacity = MCTS_UNUSED - 1;
+
+	memset (t, 0, sizeof *t);
+	t->nodes = malloc (capacity * sizeof *t->nodes);
+	t->forward = malloc (capacity * sizeof *t->forward);
+	if ( !t->nodes || !t->forward ) {
+		fprintf (stderr, "mcts_tree_create: sem memoria para %d MB\n", mb);
+		mcts_tree_destroy (t);
+		return -1;
+	}
+
+	t->capacity = (uint32_t)capacity;
+	t->mb = mb;
+	return 0;
+}
+
+static void mcts_node_init (MctsNode* n, Move mv) {
+	n->move = mv;
+	n->first = 0;
+	n->count = 0;
+	atomic_init (&n->state, MCTS_LEAF);
+	atomic_init (&n->visits, 0);
+	atomic_init (&n->reward, 0);
+}
+
+/* arvore nova so com a raiz */
+static void mcts_tree_reset (MctsTree* t, const Game* game) {
+	mcts_node_init (&t->nodes[0], MOVE_NONE);
+	atomic_store (&t->next, 1);
+	t->root = *game;
+	t->has_root = 1;
+}
+
+static int mcts_same_position (const Game* a, const Game* b) {
+	return a->key == b->key && a->dogs == b->dogs && a->jaguar_pos == b->jaguar_pos && a->to_move == b->to_move;
+}
+
+/* no com a posicao game ate duas meias jogadas abaixo da raiz, ou MCTS_UNUSED */
+static uint32_t mcts_tree_find (const MctsTree* t, const Game* game) {
+	if ( mcts_same_position (&t->root, game) )
+		return 0;
+
+	const MctsNode* root = &t->nodes[0];
+	if ( atomic_load (&root->state) != MCTS_EXPANDED )
+		return MCTS_UNUSED;
+
+	for ( int i = 0; i < root->count; i++ ) {
+		uint32_t c = root->first + (uint32_t)i;
+		const MctsNode* child = &t->nodes[c];
+		Game g = t->root;
+
+		game_apply_move (&g, child->move);
+		if ( mcts_same_position (&g, game) )
+			return c;
+		if ( atomic_load (&child->state) != MCTS_EXPANDED )
+			continue;
+
+		for ( int j = 0; j < child->count; j++ ) {
+			uint32_t gc = child->first + (uint32_t)j;
+			Game h = g;
+
+			game_apply_move (&h, t->nodes[gc].move);
+			if ( mcts_same_position (&h, game) )
+				return gc;
+		}
+	}
+
+	return MCTS_UNUSED;
+}
+
+/* leva a subarvore de r para o inicio do pool, com r no indice 0. Os
+   filhos sempre ficam depois do pai, entao uma varredura crescente marca
+   a subarvore, e os nos mantidos so andam para tras (blocos de irmaos
+   continuam contiguos) */
+static void mcts_tree_compact (MctsTree* t, uint32_t r) {
+	uint32_t used = atomic_load (&t->next);
+	if ( used > t->capacity )
+		used = t->capacity;
+
+	for ( uint32_t i = 0; i < used; i++ )
+		t->forward[i] = MCTS_UNUSED;
+
+	t->forward[r] = 0;
+	for ( uint32_t i = r; i < used; i++ ) {
+		const MctsNode* n = &t->nodes[i];
+		if ( t->forward[i] == MCTS_UNUSED || atomic_load (&n->state) != MCTS_EXPANDED )
+			continue;
+		for ( int c = 0; c < n->count; c++ )
+			t->forward[n->first + (uint32_t)c] = 0;
+	}
+
+	uint32_t kept = 0;
+	for ( uint32_t i = r; i < used; i++ ) {
+		if ( t->forward[i] != MCTS_UNUSED )
+			t->forward[i] = kept++;
+	}
+
+	for ( uint32_t i = r; i < used; i++ ) {
+		if ( t->forward[i] == MCTS_UNUSED )
+			continue;
+
+		const MctsNode* src = &t->nodes[i];
+		MctsNode* dst = &t->nodes[t->forward[i]];
+		int32_t state = atomic_load (&src->state);
+
+		dst->move = src->move;
+		dst->count = src->count;
+		dst->first = (state == MCTS_EXPANDED && src->count > 0) ? t->forward[src->first] : 0;
+		atomic_store (&dst->state, state);
+		atomic_store (&dst->visits, atomic_load (&src->visits));
+		atomic_store (&dst->reward, atomic_load (&src->reward));
+	}
+
+	t->nodes[0].move = MOVE_NONE;
+	atomic_store (&t->next, kept);
+}
+
+/* reaproveita a subarvore de game, se ela estiver na arvore anterior */
+static int mcts_tree_reuse (MctsTree* t, const Game* game) {
+	if ( !t->has_root )
+		return 0;
+
+	uint32_t r = mcts_tree_find (t, game);
+	if ( r == MCTS_UNUSED )
+		return 0;
+
+	if ( r != 0 )
+		mcts_tree_compact (t, r);
+	t->root = *game;
+	return 1;
+}
+
+static MctsTree* mcts_tree_acquire (const AiConfig* cfg, MctsTree* local) {
+	pthread_mutex_lock (&mcts_lock);
+
+	if ( !mcts_busy ) {
+		if ( !mcts_tree.nodes || mcts_tree.mb != cfg->mcts_mb ) {
+			mcts_tree_destroy (&mcts_tree);
+			if ( mcts_tree_create (&mcts_tree, cfg->mcts_mb) != 0 ) {
+				pthread_mutex_unlock (&mcts_lock);
+				return NULL;
+			}
+		}
+		mcts_busy = 1;
+		pthread_mutex_unlock (&mcts_lock);
+		return &mcts_tree;
+	}
+
+	pthread_mutex_unlock (&mcts_lock);
+	return mcts_tree_create (local, cfg->mcts_mb) == 0 ? local : NULL;
+}
+
+static void mcts_tree_done (MctsTree* t) {
+	if ( t != &mcts_tree ) {
+		mcts_tree_destroy (t);
+		return;
+	}
+
+	pthread_mutex_lock (&mcts_lock);
+	mcts_busy = 0;
+	pthread_mutex_unlock (&mcts_lock);
+}
+
+void mcts_release (void) {
+	pthread_mutex_lock (&mcts_lock);
+	if ( !mcts_busy )
+		mcts_tree_destroy (&mcts_tree);
+	pthread_mutex_unlock (&mcts_lock);
+}
+
+/* ---------------- Busca ---------------- */
+
+/* gera os filhos de n (posicao g); 0 se outra thread chegou antes ou se
+   o pool acabou: quem chamou faz o playout dali mesmo. <0 se
+   game_generate_moves falhou */
+static int mcts_expand (MctsTree* t, MctsNode* n, const Game* g, GameJumpTable* jumps) {
+	/* pool cheio: a arvore para de crescer, os playouts continuam */
+	if ( atomic_load_explicit (&t->next, memory_order_relaxed) >= t->capacity )
+		return 0;
+
+	int32_t leaf = MCTS_LEAF;
+	if ( !atomic_compare_exchange_strong (&n->state, &leaf, MCTS_EXPANDING) )
+		return 0;
+
+	Move moves[GAME_MAX_MOVES];
+	int count = 0;
+	if ( game_generate_moves (g, moves, GAME_MAX_MOVES, &count, jumps) != 0 ) {
+		atomic_store (&n->state, MCTS_LEAF);
+		return -1;
+	}
+
+	uint32_t first = 0;
+	if ( count > 0 ) {
+		first = atomic_fetch_add (&t->next, (uint32_t)count);
+		if ( first > t->capacity || t->capacity - first < (uint32_t)count ) {
+			atomic_store (&n->state, MCTS_LEAF);
+			return 0;
+		}
+
+		for ( int i = 0; i < count; i++ )
+			mcts_node_init (&t->nodes[first + (uint32_t)i], moves[i]);
+	}
+
+	n->first = first;
+	n->count = count;
+	atomic_store_explicit (&n->state, MCTS_EXPANDED, memory_order_release);
+	return 1;
+}
+
+/* filho de maior UCT; filhos nunca visitados primeiro */
+static uint32_t mcts_select (const MctsTree* t, const MctsNode* n) {
+	int32_t parent = atomic_load_explicit (&n->visits, memory_order_relaxed);
+	double log_parent = log (parent > 1 ? (double)parent : 1.0);
+	uint32_t best = n->first;
+	double best_uct = -1.0;
+
+	for ( int i = 0; i < n->count; i++ ) {
+		const MctsNode* c = &t->nodes[n->first + (uint32_t)i];
+		int32_t visits = atomic_load_explicit (&c->visits, memory_order_relaxed);
+
+		if ( visits <= 0 )
+			return n->first + (uint32_t)i;
+
+		double q = (double)atomic_load_explicit (&c->reward, memory_order_relaxed) / (2.0 * visits);
+		double uct = q + MCTS_UCT_C * sqrt (log_parent / visits);
+
+		if ( uct > best_uct ) {
+			best_uct = uct;
+			best = n->first + (uint32_t)i;
+		}
+	}
+
+	return best;
+}
+
+/* playout heuristico: a onca captura sempre que pode (a cadeia mais
+   longa); os caes preferem lances que nao deixam salto para a onca */
+static Move mcts_heuristic_move (MctsWorker* w, Game* g, const Move moves[], int count) {
+	int start = (int)(mcts_random (&w->rng) % (uint64_t)count);
+
+	if ( g->to_move == CELL_JAGUAR ) {
+		Move best = moves[start];
+		int best_captures = 0;
+
+		for ( int i = 0; i < count; i++ ) {
+			Move mv = moves[(start + i) % count];
+			int captures = bb_popcount (move_captured (mv));
+			if ( captures > best_captures ) {
+				best_captures = captures;
+				best = mv;
+			}
+		}
+		return best;
+	}
+
+	for ( int i = 0; i < count; i++ ) {
+		Move mv = moves[(start + i) % count];
+		GameUndo undo;
+
+		if ( game_make_move (g, mv, &undo) != 0 )
+			continue;
+		int safe = game_jaguar_threats (g) == BB_EMPTY;
+		game_unmake_move (g, mv, &undo);
+
+		if ( safe )
+			return mv;
+	}
+
+	return moves[start];
+}
+
+/* joga ate o fim a partir de g; *winner recebe o vencedor (CELL_EMPTY =
+   empate). <0 se game_generate_moves falhar */
+static int mcts_playout (MctsWorker* w, Game* g, CellContent* winner) {
+	const TableBase* tb = w->cfg->tablebase;
+
+	*winner = CELL_EMPTY;
+	for ( int ply = 0; ply < MCTS_PLAYOUT_MAX; ply++ ) {
+		if ( g->winner != CELL_EMPTY ) {
+			*winner = g->winner;
+			return 0;
+		}
+
+		TBResult r;
+		int distance;
+		if ( tb && tb_probe (tb, g, &r, &distance) ) {
+			if ( r != TB_DRAW )
+				*winner = r == TB_WIN ? g->to_move : mcts_opposite (g->to_move);
+			return 0;
+		}
+
+		Move moves[GAME_MAX_MOVES];
+		int count = 0;
+		if ( game_generate_moves (g, moves, GAME_MAX_MOVES, &count, &w->jumps) != 0 )
+			return -1;
+		if ( count == 0 )
+			return 0; /* sem lances: empate, como na busca */
+
+		Move mv = w->cfg->playout == AI_PLAYOUT_HEURISTIC ? mcts_heuristic_move (w, g, moves, count)
+														  : moves[mcts_random (&w->rng) % (uint64_t)count];
+		game_apply_move (g, mv);
+	}
+
+	return 0;
+}
+
+/* uma iteracao: descida com perda virtual, expansao, playout, retropropagacao */
+static void mcts_iterate (MctsWorker* w) {
+	MctsTree* t = w->tree;
+	Game g = *w->root;
+	uint32_t path[MCTS_MAX_PATH];
+	CellContent mover[MCTS_MAX_PATH]; /* quem fez o lance que leva a path[i] */
+	int len = 0;
+	uint32_t cur = 0;
+
+	path[len] = 0;
+	mover[len] = mcts_opposite (g.to_move);
+	len++;
+	atomic_fetch_add_explicit (&t->nodes[0].visits, MCTS_VIRTUAL_LOSS, memory_order_relaxed);
+
+	while ( g.winner == CELL_EMPTY && len < MCTS_MAX_PATH ) {
+		MctsNode* n = &t->nodes[cur];
+		int32_t state = atomic_load_explicit (&n->state, memory_order_acquire);
+
+		if ( state == MCTS_LEAF ) {
+			/* expande a partir da segunda visita (a raiz, sempre) */
+			int32_t visits = atomic_load_explicit (&n->visits, memory_order_relaxed);
+			if ( cur == 0 || visits > MCTS_VIRTUAL_LOSS ) {
+				int expanded = mcts_expand (t, n, &g, &w->jumps);
+				if ( expanded < 0 ) {
+					w->failed = 1;
+					return;
+				}
+				if ( expanded )
+					continue;
+			}
+			break;
+		}
+
+		if ( state != MCTS_EXPANDED || n->count == 0 )
+			break;
+
+		uint32_t c = mcts_select (t, n);
+		atomic_fetch_add_explicit (&t->nodes[c].visits, MCTS_VIRTUAL_LOSS, memory_order_relaxed);
+
+		path[len] = c;
+		mover[len] = g.to_move;
+		len++;
+
+		game_apply_move (&g, t->nodes[c].move);
+		cur = c;
+	}
+
+	CellContent winner;
+	if ( mcts_playout (w, &g, &winner) != 0 ) {
+		w->failed = 1;
+		return;
+	}
+
+	for ( int i = 0; i < len; i++ ) {
+		MctsNode* n = &t->nodes[path[i]];
+		int64_t points = winner == CELL_EMPTY ? 1 : (winner == mover[i] ? 2 : 0);
+
+		atomic_fetch_add_explicit (&n->reward, points, memory_order_relaxed);
+		atomic_fetch_add_explicit (&n->visits, 1 - MCTS_VIRTUAL_LOSS, memory_order_relaxed);
+	}
+}
+
+static void* mcts_worker_main (void* arg) {
+	MctsWorker* w = arg;
+	long long done = 0;
+
+	while ( !atomic_load_explicit (w->stop, memory_order_relaxed) ) {
+		mcts_iterate (w);
+		if ( w->failed ) {
+			atomic_store (w->stop, 1);
+			break;
+		}
+		done++;
+
+		long long total = atomic_fetch_add_explicit (w->playouts, 1, memory_order_relaxed) + 1;
+		if ( (w->limit && total >= w->limit) ||
+			 (w->deadline_ms && (done & 63) == 0 && mcts_now_ms () >= w->deadline_ms) )
+			atomic_store (w->stop, 1);
+	}
+
+	return NULL;
+}
+
+/* linha mais visitada a partir da raiz: lance, valor e variante principal */
+static void mcts_fill_result (const MctsTree* t, const Game* game, const AiConfig* cfg, AiResult* result) {
+	uint32_t cur = 0;
+
+	result->pv_len = 0;
+	while ( result->pv_len < AI_MAX_DEPTH ) {
+		const MctsNode* n = &t->nodes[cur];
+		if ( atomic_load (&n->state) != MCTS_EXPANDED || n->count == 0 )
+			break;
+
+		uint32_t best = MCTS_UNUSED;
+		int32_t best_visits = 0;
+		for ( int i = 0; i < n->count; i++ ) {
+			int32_t visits = atomic_load (&t->nodes[n->first + (uint32_t)i].visits);
+			if ( visits > best_visits ) {
+				best_visits = visits;
+				best = n->first + (uint32_t)i;
+			}
+		}
+
+		if ( best == MCTS_UNUSED )
+			break;
+
+		if ( result->pv_len == 0 ) {
+			/* taxa de vitoria de quem joga na raiz, em termos de cfg->side */
+			double q = (double)atomic_load (&t->nodes[best].reward) / (2.0 * best_visits);
+			int score = (int)lround ((2.0 * q - 1.0) * MCTS_SCORE_SCALE);
+			result->score = game->to_move == cfg->side ? score : -score;
+		}
+
+		result->pv[result->pv_len++] = t->nodes[best].move;
+		cur = best;
+	}
+
+	result->depth = result->pv_len;
+	if ( result->pv_len > 0 )
+		result->best_move = result->pv[0];
+}
+
+int mcts_search (const Game* game, const AiConfig* cfg, AiResult* result) {
+	int nthreads = cfg->threads < 1 ? 1 : cfg->threads;
+	if ( nthreads > AI_MAX_THREADS )
+		nthreads = AI_MAX_THREADS;
+
+	MctsWorker* workers = malloc ((size_t)nthreads * sizeof *workers);
+	if ( !workers ) {
+		fprintf (stderr, "mcts_search: sem memoria para %d threads\n", nthreads);
+		return -6;
+	}
+
+	Move moves[GAME_MAX_MOVES];
+	int count = 0;
+
+	if ( game_generate_moves (game, moves, GAME_MAX_MOVES, &count, &workers[0].jumps) != 0 ) {
+		fprintf (stderr, "mcts_search: game_generate_moves falhou\n");
+		free (workers);
+		return -2;
+	}
+
+	if ( count <= 0 ) {
+		free (workers);
+		return 1;
+	}
+
+	MctsTree local;
+	MctsTree* t = mcts_tree_acquire (cfg, &local);
+	if ( !t ) {
+		free (workers);
+		return -5;
+	}
+
+	if ( !mcts_tree_reuse (t, game) )
+		mcts_tree_reset (t, game);
+
+	atomic_int stop = 0;
+	_Atomic long long playouts = 0;
+	long long deadline_ms = cfg->time_ms > 0 ? mcts_now_ms () + cfg->time_ms : 0;
+	long long limit = cfg->mcts_playouts;
+	if ( limit <= 0 && !deadline_ms )
+		limit = MCTS_DEFAULT_PLAYOUTS;
+
+	for ( int t_id = 0; t_id < nthreads; t_id++ ) {
+		MctsWorker* w = &workers[t_id];
+
+		w->tree = t;
+		w->root = game;
+		w->cfg = cfg;
+		w->stop = &stop;
+		w->playouts = &playouts;
+		w->limit = limit > 0 ? limit : 0;
+		w->deadline_ms = deadline_ms;
+		w->rng = 0x2545F4914F6CDD1DULL * (uint64_t)(t_id + 1) ^ game->key;
+		if ( !w->rng )
+			w->rng = 1;
+		w->failed = 0;
+	}
+
+	int started = 1;
+	for ( int t_id = 1; t_id < nthreads; t_id++ ) {
+		if ( pthread_create (&workers[t_id].thread, NULL, mcts_worker_main, &workers[t_id]) != 0 ) {
+			fprintf (stderr, "mcts_search: pthread_create falhou (thread %d)\n", t_id);
+			break;
+		}
+		started++;
+	}
+
+	mcts_worker_main (&workers[0]);
+
+	atomic_store (&stop, 1);
+	int failed = 0;
+	for ( int t_id = 0; t_id < started; t_id++ ) {
+		if ( t_id > 0 )
+			pthread_join (workers[t_id].thread, NULL);
+		failed |= workers[t_id].failed;
+	}
+
+	/* a descida que falhou deixou perdas virtuais: a arvore nao serve mais */
+	if ( failed ) {
+		fprintf (stderr, "mcts_search: game_generate_moves falhou durante a busca\n");
+		t->has_root = 0;
+		free (workers);
+		mcts_tree_done (t);
+		return -7;
+	}
+
+	memset (result, 0, sizeof *result);
+	result->best_move = moves[0]; /* se o pool nao coube nem a raiz */
+	mcts_fill_result (t, game, cfg, result);
+	result->nodes = atomic_load (&playouts);
+
+	free (workers);
+	mcts_tree_done (t);
+	return 0;
+}
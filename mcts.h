@@ -0,0 +1,48 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include "ai.h"
+#include "game.h"
+
+#define MCTS_UCT_C 1.2			  /* peso da exploracao no UCT */
+#define MCTS_VIRTUAL_LOSS 3		  /* visitas sem premio marcadas na descida */
+#define MCTS_PLAYOUT_MAX 300	  /* meias jogadas de um playout; depois disso, empate */
+#define MCTS_MAX_PATH 256		  /* profundidade maxima de uma descida na arvore */
+#define MCTS_SCORE_SCALE 1000	  /* AiResult.score = (2 * taxa de vitoria - 1) * escala */
+#define MCTS_DEFAULT_PLAYOUTS 20000 /* sem tempo nem cfg->mcts_playouts */
+
+/**
+ * @brief Monte Carlo Tree Search (UCT) para o lado em game->to_move.
+ *
+ * Cada iteracao desce pela arvore escolhendo o filho de maior
+ * UCT = q + C * sqrt (ln N / n), expande a folha, joga um playout ate o
+ * fim (cfg->playout: lances aleatorios ou com a heuristica de capturas) e
+ * soma o resultado (vitoria 1, empate 1/2) em todos os nos do caminho, do
+ * ponto de vista de quem fez o lance que leva a cada no.
+ *
+ * Com cfg->threads > 1 todas as threads descem a mesma arvore (paralelismo
+ * de arvore): contadores atomicos, e cada no do caminho recebe
+ * MCTS_VIRTUAL_LOSS visitas sem premio ate o playout voltar, o que
+ * afasta as outras threads da mesma linha.
+ *
+ * Os nos vem de um pool alocado uma vez (cfg->mcts_mb) e ficam entre
+ * chamadas: se game aparece ate duas meias jogadas abaixo da raiz
+ * anterior, a subarvore dele eh compactada no inicio do pool e reaproveitada.
+ *
+ * Para no prazo cfg->time_ms, depois de cfg->mcts_playouts playouts ou,
+ * sem nenhum dos dois, depois de MCTS_DEFAULT_PLAYOUTS. O lance eh o filho
+ * da raiz mais visitado; AiResult.nodes conta os playouts, depth e pv vem
+ * da linha mais visitada.
+ *
+ * @return 0 em sucesso, >0 se nao ha movimentos, <0 em erro.
+ */
+int mcts_search (const Game* game, const AiConfig* cfg, AiResult* result);
+
+/**
+ * @brief Libera o pool de nos mantido entre buscas.
+ *
+ * Nao faz nada se houver uma busca em andamento.
+ */
+void mcts_release (void);
+
+#endif /* MCTS_H */
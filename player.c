@@ -42,7 +42,7 @@ static int human_read_move (const Game* game, Move* mv) {
 		return -2;
 	}
 
-	if ( game_is_legal_move (game, mv) != 1 ) {
+	if ( game_is_legal_move (game, *mv) != 1 ) {
 		fprintf (stderr, "humano: movimento ilegal\n");
 		return -3;
 	}
@@ -54,6 +54,7 @@ int main (void) {
 	Game game;
 
 	AiConfig ai;
+	ai_config_default (&ai);
 	ai.max_depth = 7;
 	int err;
 
@@ -123,7 +124,7 @@ int main (void) {
 		}
 
 		char buf[128];
-		if ( game_move_to_controller (&game, &best, buf, (int)sizeof buf) != 0 ) {
+		if ( game_move_to_controller (&game, best, buf, (int)sizeof buf) != 0 ) {
 			fprintf (stderr,
 					 "player: game_move_to_controller falhou (agente)\n");
 			break;
@@ -131,11 +132,12 @@ int main (void) {
 
 		printf ("Agente joga: %s\n", buf);
 
-		if ( game_apply_move (&game, &best) != 0 ) {
+		if ( game_apply_move (&game, best) != 0 ) {
 			fprintf (stderr, "player: game_apply_move falhou (agente)\n");
 			break;
 		}
 	}
 
+	ai_release ();
 	return 0;
 }
@@ -0,0 +1,168 @@
+#include "rank.h"
+
+#include <pthread.h>
+#include <stdio.h>
+
+/* C(n, k); a linha n = GRAPH_MAX_VERTICES ainda cabe em 64 bits */
+static uint64_t rank_binom[GRAPH_MAX_VERTICES + 1][GRAPH_MAX_VERTICES + 1];
+static pthread_once_t rank_once = PTHREAD_ONCE_INIT;
+
+static void rank_init (void) {
+	for ( int n = 0; n <= GRAPH_MAX_VERTICES; n++ ) {
+		rank_binom[n][0] = 1;
+		for ( int k = 1; k <= n; k++ )
+			rank_binom[n][k] = rank_binom[n - 1][k - 1] + rank_binom[n - 1][k];
+	}
+}
+
+uint64_t rank_binomial (int n, int k) {
+	pthread_once (&rank_once, rank_init);
+
+	if ( n < 0 || k < 0 || n > GRAPH_MAX_VERTICES || k > n )
+		return 0;
+	return rank_binom[n][k];
+}
+
+static inline uint64_t rank_subset_raw (Bitboard set) {
+	uint64_t r = 0;
+
+	for ( int i = 1; set; i++ )
+		r += rank_binom[bb_pop_lsb (&set)][i];
+	return r;
+}
+
+uint64_t rank_subset (Bitboard set) {
+	pthread_once (&rank_once, rank_init);
+	return rank_subset_raw (set);
+}
+
+Bitboard rank_subset_unrank (uint64_t r, int k) {
+	pthread_once (&rank_once, rank_init);
+
+	/* elemento i (do maior para o menor): maior v com C(v, i) <= r,
+	   procurado abaixo do elemento anterior; C(i - 1, i) = 0 para o laco */
+	Bitboard set = BB_EMPTY;
+	int v = GRAPH_MAX_VERTICES - 1;
+
+	for ( int i = k; i >= 1; i-- ) {
+		while ( rank_binom[v][i] > r )
+			v--;
+		r -= rank_binom[v][i];
+		set |= BB_BIT (v);
+		v--;
+	}
+	return set;
+}
+
+uint64_t rank_layer_size (int n, int k) {
+	return 2u * (uint64_t)n * rank_binomial (n - 1, k);
+}
+
+/* tira o vertice j do conjunto: os de cima descem uma posicao */
+static inline Bitboard rank_squeeze (Bitboard set, int j) {
+	Bitboard low = BB_BIT (j) - 1;
+	return (set & low) | ((set >> 1) & ~low);
+}
+
+/* inverso de rank_squeeze */
+static inline Bitboard rank_spread (Bitboard set, int j) {
+	Bitboard low = BB_BIT (j) - 1;
+	return (set & low) | ((set & ~low) << 1);
+}
+
+static inline uint64_t rank_position_raw (const Game* game) {
+	int n = game->g->num_vertices;
+	int k = bb_popcount (game->dogs);
+	uint64_t side = game->to_move == CELL_JAGUAR ? 1 : 0;
+
+	/* a onca nunca esta num vertice com cao: o bit dela eh sempre 0 */
+	uint64_t dogs = rank_subset_raw (rank_squeeze (game->dogs, game->jaguar_pos));
+	return (side * (uint64_t)n + (uint64_t)game->jaguar_pos) * rank_binom[n - 1][k] + dogs;
+}
+
+uint64_t rank_position (const Game* game) {
+	pthread_once (&rank_once, rank_init);
+	return rank_position_raw (game);
+}
+
+void rank_positions (const Game games[], int count, uint64_t out[]) {
+	pthread_once (&rank_once, rank_init);
+
+	for ( int i = 0; i < count; i++ )
+		out[i] = rank_position_raw (&games[i]);
+}
+
+int rank_position_unrank (Game* game, int k, uint64_t index) {
+	int n = game->g->num_vertices;
+
+	if ( k < 0 || k > n - 1 || index >= rank_layer_size (n, k) ) {
+		fprintf (stderr, "rank_position_unrank: indice %llu fora da faixa (%d caes)\n", (unsigned long long)index, k);
+		return -1;
+	}
+
+	uint64_t count = rank_binom[n - 1][k];
+	uint64_t rest = index / count;
+
+	game->jaguar_pos = (int)(rest % (uint64_t)n);
+	game->to_move = rest / (uint64_t)n ? CELL_JAGUAR : CELL_DOG;
+	game->dogs = rank_spread (rank_subset_unrank (index % count, k), game->jaguar_pos);
+	game->winner = game_compute_winner (game);
+	game->key = game_compute_key (game);
+	game->mirror_key = game_compute_mirror_key (game);
+	game->psq = game_compute_psq (game);
+	return 0;
+}
+
+uint64_t rank_canonical_layer_size (const Graph* g, int k) {
+	uint64_t slots = (uint64_t)bb_popcount (g->mirror_canon);
+	return 2u * slots * rank_binomial (g->num_vertices - 1, k);
+}
+
+uint64_t rank_canonical (const Game* game) {
+	pthread_once (&rank_once, rank_init);
+
+	const Graph* g = game->g;
+	int n = g->num_vertices;
+	int k = bb_popcount (game->dogs);
+	int jaguar = game->jaguar_pos;
+	Bitboard dogs = game->dogs;
+
+	if ( game_mirror_needed (game) ) {
+		jaguar = g->mirror[jaguar];
+		dogs = game_mirror_mask (dogs);
+	}
+
+	uint64_t side = game->to_move == CELL_JAGUAR ? 1 : 0;
+	uint64_t slots = (uint64_t)bb_popcount (g->mirror_canon);
+	uint64_t slot = (uint64_t)bb_popcount (g->mirror_canon & (BB_BIT (jaguar) - 1));
+
+	return (side * slots + slot) * rank_binom[n - 1][k] + rank_subset_raw (rank_squeeze (dogs, jaguar));
+}
+
+int rank_canonical_unrank (Game* game, int k, uint64_t index) {
+	const Graph* g = game->g;
+	int n = g->num_vertices;
+
+	if ( k < 0 || k > n - 1 || index >= rank_canonical_layer_size (g, k) ) {
+		fprintf (stderr, "rank_canonical_unrank: indice %llu fora da faixa (%d caes)\n", (unsigned long long)index, k);
+		return -1;
+	}
+
+	uint64_t count = rank_binom[n - 1][k];
+	uint64_t slots = (uint64_t)bb_popcount (g->mirror_canon);
+	uint64_t rest = index / count;
+
+	/* slot-esimo vertice de mirror_canon */
+	Bitboard canon = g->mirror_canon;
+	for ( uint64_t s = rest % slots; s > 0; s-- )
+		bb_pop_lsb (&canon);
+
+	game->jaguar_pos = bb_lsb (canon);
+	game->to_move = rest / slots ? CELL_JAGUAR : CELL_DOG;
+	game->dogs = rank_spread (rank_subset_unrank (index % count, k), game->jaguar_pos);
+	game->winner = game_compute_winner (game);
+	game->key = game_compute_key (game);
+	game->mirror_key = game_compute_mirror_key (game);
+	game->psq = game_compute_psq (game);
+	return 0;
+}
@@ -0,0 +1,91 @@
+#ifndef RANK_H
+#define RANK_H
+
+#include <stdint.h>
+
+#include "game.h"
+
+/**
+ * @brief Numeracao densa de posicoes (hash perfeito, sem chaves).
+ *
+ * Para um numero fixo k de caes, cada posicao (lado a jogar, vertice da
+ * onca, conjunto de caes) recebe um indice unico em [0, rank_layer_size):
+ *
+ *   indice = (lado * V + onca) * C(V - 1, k) + posto(caes)
+ *
+ * onde V eh o numero de vertices do grafo, lado eh 0 para os caes e 1
+ * para a onca, e o posto eh o sistema combinatorio sobre os V - 1 vertices
+ * que sobram tirando a onca: caes c0 < c1 < ... valem
+ * C(c0, 1) + C(c1, 2) + ... . Os binomiais vem de uma tabela.
+ */
+
+/**
+ * @brief C(n, k) para 0 <= k <= n <= GRAPH_MAX_VERTICES (0 fora disso).
+ */
+uint64_t rank_binomial (int n, int k);
+
+/**
+ * @brief Posto colex do conjunto set (com popcount(set) elementos).
+ */
+uint64_t rank_subset (Bitboard set);
+
+/**
+ * @brief Inverso de rank_subset: o conjunto de k elementos com posto r.
+ */
+Bitboard rank_subset_unrank (uint64_t r, int k);
+
+/**
+ * @brief Numero de posicoes com k caes num grafo de n vertices.
+ */
+uint64_t rank_layer_size (int n, int k);
+
+/**
+ * @brief Indice da posicao de game (com onca) entre as de mesmo numero de caes.
+ */
+uint64_t rank_position (const Game* game);
+
+/**
+ * @brief Indices de count posicoes de uma vez (todas com onca).
+ *
+ * Mesmo resultado que rank_position em cada uma, num laco so, sem
+ * chamadas por posicao.
+ */
+void rank_positions (const Game games[], int count, uint64_t out[]);
+
+/**
+ * @brief Inverso de rank_position.
+ *
+ * game->g deve apontar para o grafo (game_init). Preenche caes, onca,
+ * lado a jogar, vencedor e chave.
+ *
+ * @param game  Posicao (saida).
+ * @param k     Numero de caes.
+ * @param index Indice em [0, rank_layer_size (V, k)).
+ * @return 0 em sucesso, <0 se o indice esta fora da faixa.
+ */
+int rank_position_unrank (Game* game, int k, uint64_t index);
+
+/**
+ * @brief Numeracao so das formas canonicas (espelho, Graph.mirror).
+ *
+ * Igual a rank_position, mas a onca so ocupa os vertices de
+ * Graph.mirror_canon (numerados em ordem): posicao e espelho recebem o
+ * mesmo indice e a camada fica com pouco mais da metade do tamanho. Com
+ * a onca no eixo as duas orientacoes dos caes continuam numeradas.
+ */
+uint64_t rank_canonical_layer_size (const Graph* g, int k);
+
+/**
+ * @brief Indice da forma canonica de game (com onca).
+ */
+uint64_t rank_canonical (const Game* game);
+
+/**
+ * @brief Inverso de rank_canonical: preenche game com a onca num vertice
+ * de Graph.mirror_canon.
+ *
+ * @return 0 em sucesso, <0 se o indice esta fora da faixa.
+ */
+int rank_canonical_unrank (Game* game, int k, uint64_t index);
+
+#endif /* RANK_H */
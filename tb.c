@@ -0,0 +1,400 @@
+#include "tb.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rank.h"
+
+#define TB_MAX_DISTANCE 0x7ffe
+
+/* a camada em construcao (atomica) vira a camada final no mesmo vetor */
+_Static_assert (sizeof (_Atomic uint16_t) == sizeof (uint16_t), "_Atomic uint16_t deve ter 2 bytes");
+
+/* cabecalho do arquivo; as camadas min_dogs..max_dogs vem logo depois */
+typedef struct {
+	char magic[8];
+	uint32_t num_vertices;
+	uint32_t win_dogs; /* GAME_JAGUAR_WIN_DOGS de quem gerou */
+	uint32_t min_dogs;
+	uint32_t max_dogs;
+	uint64_t graph_hash; /* vizinhancas e saltos: o mapa tem que ser o mesmo */
+} TbHeader;
+
+static inline uint16_t tb_encode_win (int distance) {
+	return (uint16_t)(distance + 1);
+}
+
+static inline uint16_t tb_encode_loss (int distance) {
+	return (uint16_t)((distance + 1) | TB_LOSS_BIT);
+}
+
+/* so formas canonicas: posicao e espelho dividem a entrada */
+static size_t tb_layer_size (const Graph* g, int k) {
+	return (size_t)rank_canonical_layer_size (g, k);
+}
+
+/* ---------------- Construcao ---------------- */
+
+/* uma faixa de indices da camada em construcao, numa rodada */
+typedef struct {
+	const TableBase* tb;	  /* camadas menores, ja prontas */
+	_Atomic uint16_t* cur; /* camada k, lida e escrita por todas as threads */
+	Game base;				  /* Game com o grafo, copiado para cada posicao */
+	int k;
+	int level;
+
+	size_t lo, hi;
+	size_t changed;
+	int failed;			/* game_generate_moves falhou nesta rodada */
+	GameJumpTable jumps; /* estados das cadeias de saltos desta thread */
+	pthread_t thread;
+} TbWorker;
+
+/* valor do filho para quem joga nele (0 = ainda sem valor / empate) */
+static uint16_t tb_child_value (const TbWorker* w, const Game* child) {
+	if ( child->winner != CELL_EMPTY )
+		return child->winner == child->to_move ? tb_encode_win (0) : tb_encode_loss (0);
+
+	int n = game_num_dogs (child);
+	size_t idx = (size_t)rank_canonical (child);
+
+	if ( n == w->k )
+		return atomic_load_explicit (&w->cur[idx], memory_order_relaxed);
+	return w->tb->layer[n][idx];
+}
+
+/* rodada w->level: so posicoes ainda sem valor, olhando os filhos. Um
+   valor escrito nesta rodada tem distancia level e nao decide nada aqui,
+   entao a ordem entre as threads nao muda o resultado */
+static void* tb_worker_main (void* arg) {
+	TbWorker* w = arg;
+	Game g = w->base;
+	int level = w->level;
+
+	w->changed = 0;
+	w->failed = 0;
+
+	for ( size_t idx = w->lo; idx < w->hi; idx++ ) {
+		if ( atomic_load_explicit (&w->cur[idx], memory_order_relaxed) != 0 )
+			continue;
+
+		rank_canonical_unrank (&g, w->k, idx);
+
+		if ( level == 0 ) {
+			if ( g.winner != CELL_EMPTY ) {
+				uint16_t v = g.winner == g.to_move ? tb_encode_win (0) : tb_encode_loss (0);
+				atomic_store_explicit (&w->cur[idx], v, memory_order_relaxed);
+				w->changed++;
+			}
+			continue;
+		}
+
+		Move moves[GAME_MAX_MOVES];
+		int count = 0;
+
+		if ( g.winner != CELL_EMPTY )
+			continue;
+
+		if ( game_generate_moves (&g, moves, GAME_MAX_MOVES, &count, &w->jumps) != 0 ) {
+			w->failed = 1;
+			return NULL;
+		}
+
+		if ( count == 0 )
+			continue; /* sem lances: empate, como na busca */
+
+		int win = 0;
+		int all_win = 1;
+		int max_win = -1;
+
+		for ( int i = 0; i < count && !win; i++ ) {
+			GameUndo undo;
+
+			if ( game_make_move (&g, moves[i], &undo) != 0 )
+				continue;
+
+			uint16_t v = tb_child_value (w, &g);
+			game_unmake_move (&g, moves[i], &undo);
+
+			int d;
+			TBResult r = tb_decode (v, &d);
+
+			if ( r == TB_DRAW ) {
+				all_win = 0;
+			} else if ( r == TB_LOSS ) {
+				all_win = 0;
+				win = d == level - 1;
+			} else if ( d > max_win ) {
+				max_win = d;
+			}
+		}
+
+		if ( win ) {
+			atomic_store_explicit (&w->cur[idx], tb_encode_win (level), memory_order_relaxed);
+			w->changed++;
+		} else if ( all_win && max_win + 1 == level ) {
+			atomic_store_explicit (&w->cur[idx], tb_encode_loss (level), memory_order_relaxed);
+			w->changed++;
+		}
+	}
+
+	return NULL;
+}
+
+/* uma rodada sobre a camada inteira, dividida em faixas; devolve quantas
+   posicoes ganharam valor, ou <0 em erro */
+static long long tb_run_level (TbWorker workers[], int threads, int level) {
+	int started = 0;
+
+	for ( int t = 0; t < threads; t++ ) {
+		workers[t].level = level;
+		if ( t > 0 && pthread_create (&workers[t].thread, NULL, tb_worker_main, &workers[t]) != 0 ) {
+			fprintf (stderr, "tb_build: pthread_create falhou (thread %d)\n", t);
+			break;
+		}
+		started++;
+	}
+
+	/* a faixa 0 fica com esta thread; faixas sem thread tambem */
+	tb_worker_main (&workers[0]);
+	for ( int t = started; t < threads; t++ )
+		tb_worker_main (&workers[t]);
+
+	long long changed = workers[0].changed;
+	int failed = workers[0].failed;
+	for ( int t = 1; t < threads; t++ ) {
+		if ( t < started )
+			pthread_join (workers[t].thread, NULL);
+		changed += (long long)workers[t].changed;
+		failed |= workers[t].failed;
+	}
+
+	return failed ? -1 : changed;
+}
+
+static int tb_build_layer (TableBase* tb, const Game* base, int k, int threads, int* max_distance) {
+	size_t size = tb_layer_size (base->g, k);
+	_Atomic uint16_t* cur = calloc (size, sizeof *cur);
+
+	if ( !cur ) {
+		fprintf (stderr, "tb_build: sem memoria para a camada de %d caes (%zu posicoes)\n", k, size);
+		return -2;
+	}
+
+	TbWorker* workers = malloc ((size_t)threads * sizeof *workers);
+	if ( !workers ) {
+		free (cur);
+		return -2;
+	}
+
+	for ( int t = 0; t < threads; t++ ) {
+		workers[t].tb = tb;
+		workers[t].cur = cur;
+		workers[t].base = *base;
+		workers[t].k = k;
+		workers[t].lo = size * (size_t)t / (size_t)threads;
+		workers[t].hi = size * (size_t)(t + 1) / (size_t)threads;
+	}
+
+	/* depois de uma rodada sem mudanca, so uma camada menor (distancias
+	   ate *max_distance) ainda poderia decidir algo */
+	int lower = *max_distance;
+	int level = 0;
+
+	while ( 1 ) {
+		long long changed = tb_run_level (workers, threads, level);
+
+		if ( changed < 0 ) {
+			fprintf (stderr, "tb_build: game_generate_moves falhou na camada de %d caes\n", k);
+			free (workers);
+			free (cur);
+			return -4;
+		}
+
+		if ( changed == 0 && level > lower )
+			break;
+
+		if ( ++level > TB_MAX_DISTANCE ) {
+			fprintf (stderr, "tb_build: distancia maior que %d na camada de %d caes\n", TB_MAX_DISTANCE, k);
+			free (workers);
+			free (cur);
+			return -3;
+		}
+	}
+
+	/* as threads ja terminaram: o proprio vetor vira a camada, sem copia */
+	uint16_t* layer = (uint16_t*)cur;
+
+	for ( size_t i = 0; i < size; i++ ) {
+		int d;
+		if ( tb_decode (layer[i], &d) != TB_DRAW && d > *max_distance )
+			*max_distance = d;
+	}
+
+	tb->layer[k] = layer;
+	tb->layer_size[k] = size;
+	tb->max_dogs = k;
+
+	free (workers);
+	return 0;
+}
+
+static void tb_reset (TableBase* tb, int num_vertices) {
+	memset (tb, 0, sizeof *tb);
+	tb->num_vertices = num_vertices;
+	tb->min_dogs = TB_MIN_DOGS;
+	tb->max_dogs = TB_MIN_DOGS - 1;
+}
+
+int tb_build (TableBase* tb, int max_dogs, int threads) {
+	Game base;
+
+	if ( !tb || threads < 1 ) {
+		fprintf (stderr, "tb_build: parametros invalidos\n");
+		return -1;
+	}
+
+	if ( game_init (&base) != 0 ) {
+		fprintf (stderr, "tb_build: game_init falhou\n");
+		return -1;
+	}
+
+	int n = base.g->num_vertices;
+	if ( max_dogs < TB_MIN_DOGS || max_dogs > n - 1 ) {
+		fprintf (stderr, "tb_build: max_dogs deve estar entre %d e %d\n", TB_MIN_DOGS, n - 1);
+		return -1;
+	}
+
+	tb_reset (tb, n);
+
+	int max_distance = 0; /* capturas que terminam o jogo: distancia 0 */
+
+	for ( int k = TB_MIN_DOGS; k <= max_dogs; k++ ) {
+		int err = tb_build_layer (tb, &base, k, threads, &max_distance);
+		if ( err != 0 ) {
+			tb_destroy (tb);
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+/* ---------------- Arquivo ---------------- */
+
+int tb_save (const TableBase* tb, const char* path) {
+	Game base;
+
+	if ( !tb || !path || tb->max_dogs < tb->min_dogs || game_init (&base) != 0 ) {
+		fprintf (stderr, "tb_save: parametros invalidos\n");
+		return -1;
+	}
+
+	FILE* f = fopen (path, "wb");
+	if ( !f ) {
+		fprintf (stderr, "tb_save: nao foi possivel criar %s\n", path);
+		return -2;
+	}
+
+	TbHeader h;
+	memset (&h, 0, sizeof h);
+	memcpy (h.magic, TB_MAGIC, sizeof h.magic);
+	h.num_vertices = (uint32_t)tb->num_vertices;
+	h.win_dogs = GAME_JAGUAR_WIN_DOGS;
+	h.min_dogs = (uint32_t)tb->min_dogs;
+	h.max_dogs = (uint32_t)tb->max_dogs;
+	h.graph_hash = graph_hash (base.g);
+
+	int ok = fwrite (&h, sizeof h, 1, f) == 1;
+	for ( int k = tb->min_dogs; ok && k <= tb->max_dogs; k++ )
+		ok = fwrite (tb->layer[k], sizeof (uint16_t), tb->layer_size[k], f) == tb->layer_size[k];
+
+	if ( fclose (f) != 0 )
+		ok = 0;
+
+	if ( !ok ) {
+		fprintf (stderr, "tb_save: erro ao gravar %s\n", path);
+		return -3;
+	}
+
+	return 0;
+}
+
+int tb_load (TableBase* tb, const char* path) {
+	Game base;
+
+	if ( !tb || !path || game_init (&base) != 0 ) {
+		fprintf (stderr, "tb_load: parametros invalidos\n");
+		return -1;
+	}
+
+	FILE* f = fopen (path, "rb");
+	if ( !f ) {
+		fprintf (stderr, "tb_load: nao foi possivel abrir %s\n", path);
+		return -2;
+	}
+
+	TbHeader h;
+	if ( fread (&h, sizeof h, 1, f) != 1 || memcmp (h.magic, TB_MAGIC, sizeof h.magic) != 0 ) {
+		fprintf (stderr, "tb_load: %s nao eh uma tabela de finais\n", path);
+		fclose (f);
+		return -3;
+	}
+
+	if ( h.num_vertices != (uint32_t)base.g->num_vertices || h.graph_hash != graph_hash (base.g) ||
+		 h.win_dogs != GAME_JAGUAR_WIN_DOGS || h.min_dogs != TB_MIN_DOGS || h.max_dogs < h.min_dogs ||
+		 h.max_dogs >= h.num_vertices ) {
+		fprintf (stderr, "tb_load: %s foi gerada para outro tabuleiro ou outras regras\n", path);
+		fclose (f);
+		return -4;
+	}
+
+	tb_reset (tb, base.g->num_vertices);
+
+	for ( int k = (int)h.min_dogs; k <= (int)h.max_dogs; k++ ) {
+		size_t size = tb_layer_size (base.g, k);
+		uint16_t* layer = malloc (size * sizeof *layer);
+
+		if ( !layer || fread (layer, sizeof *layer, size, f) != size ) {
+			fprintf (stderr, "tb_load: %s truncado ou sem memoria (camada de %d caes)\n", path, k);
+			free (layer);
+			tb_destroy (tb);
+			fclose (f);
+			return -5;
+		}
+
+		tb->layer[k] = layer;
+		tb->layer_size[k] = size;
+		tb->max_dogs = k;
+	}
+
+	fclose (f);
+	return 0;
+}
+
+void tb_destroy (TableBase* tb) {
+	if ( !tb )
+		return;
+
+	for ( int k = 0; k <= GRAPH_MAX_VERTICES; k++ ) {
+		free (tb->layer[k]);
+		tb->layer[k] = NULL;
+		tb->layer_size[k] = 0;
+	}
+	tb->max_dogs = tb->min_dogs - 1;
+}
+
+int tb_probe (const TableBase* tb, const Game* game, TBResult* out, int* distance) {
+	if ( !tb || game->jaguar_pos < 0 )
+		return 0;
+
+	int k = game_num_dogs (game);
+	if ( k < tb->min_dogs || k > tb->max_dogs || !tb->layer[k] )
+		return 0;
+
+	*out = tb_decode (tb->layer[k][rank_canonical (game)], distance);
+	return 1;
+}
@@ -0,0 +1,110 @@
+#ifndef TB_H
+#define TB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+
+#define TB_MAGIC "ONCATB03" /* 8 bytes no inicio do arquivo */
+
+#define TB_MIN_DOGS (GAME_JAGUAR_WIN_DOGS + 1) /* com menos caes a onca ja venceu */
+
+/**
+ * @brief Valor exato de uma posicao do ponto de vista de quem joga.
+ */
+typedef enum {
+	TB_DRAW = 0, /* ninguem forca a vitoria (ou posicao sem lances) */
+	TB_WIN,
+	TB_LOSS
+} TBResult;
+
+/**
+ * @brief Tabela de finais: valor exato de toda posicao com ate max_dogs caes.
+ *
+ * Cada camada (numero de caes k) eh um vetor plano de uint16_t, sem chaves,
+ * indexado por rank_canonical (rank.h): posicao e espelho dividem a
+ * mesma entrada. A entrada vale 0 para
+ * empate; senao (distancia + 1), com o bit 15 ligado se quem joga perde.
+ * A distancia eh contada em lances (meias jogadas) ate o fim do jogo, com
+ * o vencedor apressando e o perdedor adiando o fim (ver tb_decode).
+ */
+typedef struct {
+	int num_vertices;
+	int min_dogs; /* TB_MIN_DOGS */
+	int max_dogs; /* ultima camada presente */
+
+	uint16_t* layer[GRAPH_MAX_VERTICES + 1]; /* por numero de caes, ou NULL */
+	size_t layer_size[GRAPH_MAX_VERTICES + 1];
+} TableBase;
+
+#define TB_LOSS_BIT 0x8000u /* bit 15 da entrada: quem joga perde */
+
+/**
+ * @brief Decodifica uma entrada de camada.
+ *
+ * @param v        Entrada (formato descrito em TableBase).
+ * @param distance Saida: lances ate o fim (0 para TB_DRAW).
+ * @return Resultado para quem joga na posicao da entrada.
+ */
+static inline TBResult tb_decode (uint16_t v, int* distance) {
+	if ( v == 0 ) {
+		*distance = 0;
+		return TB_DRAW;
+	}
+
+	*distance = (int)(v & ~TB_LOSS_BIT) - 1;
+	return (v & TB_LOSS_BIT) ? TB_LOSS : TB_WIN;
+}
+
+/**
+ * @brief Resolve por analise retrograda todas as posicoes com TB_MIN_DOGS
+ * ate max_dogs caes.
+ *
+ * As camadas sao resolvidas da menor para a maior: capturas levam a uma
+ * camada ja pronta. Dentro da camada, a rodada d marca quem vence em d
+ * lances (algum filho perde em d - 1) e quem perde em d (todos os filhos
+ * vencem, o mais demorado em d - 1); o que sobra no fim eh empate. Cada
+ * rodada eh dividida entre threads por faixas de indices.
+ *
+ * @param tb       Tabela (saida); liberar com tb_destroy.
+ * @param max_dogs Maior numero de caes (>= TB_MIN_DOGS).
+ * @param threads  Threads de trabalho (>= 1).
+ * @return 0 em sucesso, <0 em erro.
+ */
+int tb_build (TableBase* tb, int max_dogs, int threads);
+
+/**
+ * @brief Grava a tabela em path (cabecalho + camadas, na ordem da maquina).
+ *
+ * @return 0 em sucesso, <0 em erro.
+ */
+int tb_save (const TableBase* tb, const char* path);
+
+/**
+ * @brief Carrega uma tabela gravada com tb_save.
+ *
+ * Recusa arquivos de outro tabuleiro ou de outro GAME_JAGUAR_WIN_DOGS.
+ *
+ * @return 0 em sucesso, <0 em erro.
+ */
+int tb_load (TableBase* tb, const char* path);
+
+/**
+ * @brief Libera as camadas.
+ */
+void tb_destroy (TableBase* tb);
+
+/**
+ * @brief Consulta a posicao de game.
+ *
+ * @param tb       Tabela.
+ * @param game     Posicao (com onca).
+ * @param out      Resultado para game->to_move.
+ * @param distance Lances ate o fim (0 se a posicao ja eh final; sem
+ *                 sentido para TB_DRAW).
+ * @return 1 se a posicao esta na tabela, 0 caso contrario.
+ */
+int tb_probe (const TableBase* tb, const Game* game, TBResult* out, int* distance);
+
+#endif /* TB_H */
@@ -0,0 +1,76 @@
+#define _POSIX_C_SOURCE 200809L /* clock_gettime */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "game.h"
+#include "tb.h"
+
+/* gerador offline da tabela de finais (tb.h) */
+
+static double tb_gen_now (void) {
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* resumo de uma camada: vitorias, derrotas e o final mais longo */
+static void tb_gen_report (const TableBase* tb, int k) {
+	long long wins = 0, losses = 0, draws = 0;
+	int longest = 0;
+
+	for ( size_t i = 0; i < tb->layer_size[k]; i++ ) {
+		int d;
+		TBResult r = tb_decode (tb->layer[k][i], &d);
+
+		if ( r == TB_DRAW )
+			draws++;
+		else if ( r == TB_LOSS )
+			losses++;
+		else
+			wins++;
+
+		if ( d > longest )
+			longest = d;
+	}
+
+	printf ("%4d caes: %12zu entradas, %12lld vitorias, %12lld derrotas, %12lld empates, maior final %d\n", k,
+			tb->layer_size[k], wins, losses, draws, longest);
+}
+
+int main (int argc, char** argv) {
+	if ( argc < 3 ) {
+		fprintf (stderr, "Uso: %s <max_caes> <arquivo> [threads]\n", argv[0]);
+		fprintf (stderr, "  resolve as posicoes com %d a max_caes caes (GAME_JAGUAR_WIN_DOGS = %d)\n", TB_MIN_DOGS,
+				 GAME_JAGUAR_WIN_DOGS);
+		return 1;
+	}
+
+	int max_dogs = atoi (argv[1]);
+	int threads = argc > 3 ? atoi (argv[3]) : 1;
+
+	if ( threads < 1 ) {
+		fprintf (stderr, "Numero de threads invalido: %s\n", argv[3]);
+		return 1;
+	}
+
+	TableBase tb;
+	double t0 = tb_gen_now ();
+
+	if ( tb_build (&tb, max_dogs, threads) != 0 )
+		return 1;
+
+	double t1 = tb_gen_now ();
+
+	for ( int k = tb.min_dogs; k <= tb.max_dogs; k++ )
+		tb_gen_report (&tb, k);
+
+	int err = tb_save (&tb, argv[2]);
+	tb_destroy (&tb);
+	if ( err != 0 )
+		return 1;
+
+	printf ("resolvida em %.2f s com %d threads, gravada em %s\n", t1 - t0, threads, argv[2]);
+	return 0;
+}
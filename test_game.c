@@ -1,9 +1,125 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "game.h"
 #include "graph.h"
 
+#define TEST_GAMES 200		/* partidas aleatorias da conferencia de make/unmake */
+#define TEST_MAX_PLIES 300 /* meias jogadas por partida */
+
+/* xorshift64: partidas aleatorias reprodutiveis */
+static uint64_t test_random (uint64_t* state) {
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+/* 1 se os dois estados sao iguais campo a campo */
+static int test_same_state (const Game* a, const Game* b) {
+	return a->g == b->g && a->dogs == b->dogs && a->jaguar_pos == b->jaguar_pos && a->to_move == b->to_move &&
+		   a->winner == b->winner && a->key == b->key && a->mirror_key == b->mirror_key && a->psq == b->psq;
+}
+
+/* confere os campos mantidos por make/unmake com o calculo do zero */
+static int test_check_incremental (const Game* g, const char* where, int game, int ply) {
+	if ( g->winner != game_compute_winner (g) ) {
+		fprintf (stderr, "test_make_unmake: vencedor errado %s (partida %d, lance %d)\n", where, game, ply);
+		return -1;
+	}
+	if ( g->key != game_compute_key (g) ) {
+		fprintf (stderr, "test_make_unmake: key difere do calculo do zero %s (partida %d, lance %d)\n", where, game, ply);
+		return -1;
+	}
+	if ( g->mirror_key != game_compute_mirror_key (g) ) {
+		fprintf (stderr, "test_make_unmake: mirror_key difere do calculo do zero %s (partida %d, lance %d)\n", where,
+				 game, ply);
+		return -1;
+	}
+	if ( g->psq != game_compute_psq (g) ) {
+		fprintf (stderr, "test_make_unmake: psq difere do calculo do zero %s (partida %d, lance %d)\n", where, game, ply);
+		return -1;
+	}
+	return 0;
+}
+
+/* partidas aleatorias a partir de start: em cada posicao todo lance (e o
+   lance nulo) eh feito, conferido e desfeito; no fim a partida inteira eh
+   desfeita e tem que voltar exatamente a start */
+static int test_make_unmake (const Game* start) {
+	static GameUndo undo[TEST_MAX_PLIES];
+	static Move line[TEST_MAX_PLIES];
+	static GameJumpTable jumps;
+	uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+	for ( int gi = 0; gi < TEST_GAMES; gi++ ) {
+		Game g = *start;
+		int n = 0;
+
+		while ( n < TEST_MAX_PLIES && g.winner == CELL_EMPTY ) {
+			Move moves[GAME_MAX_MOVES];
+			int count = 0;
+
+			if ( game_generate_moves (&g, moves, GAME_MAX_MOVES, &count, &jumps) != 0 )
+				return -1;
+			if ( count == 0 )
+				break;
+
+			for ( int i = 0; i < count; i++ ) {
+				Game before = g;
+				GameUndo u;
+
+				if ( game_make_move (&g, moves[i], &u) != 0 ) {
+					fprintf (stderr, "test_make_unmake: game_make_move falhou (partida %d, lance %d)\n", gi, n);
+					return -2;
+				}
+				if ( test_check_incremental (&g, "depois do lance", gi, n) != 0 )
+					return -3;
+
+				game_unmake_move (&g, moves[i], &u);
+				if ( !test_same_state (&g, &before) ) {
+					fprintf (stderr, "test_make_unmake: unmake nao restaurou o estado (partida %d, lance %d)\n", gi, n);
+					return -4;
+				}
+			}
+
+			Game before = g;
+			GameUndo nu;
+
+			game_make_null_move (&g, &nu);
+			if ( test_check_incremental (&g, "depois do lance nulo", gi, n) != 0 )
+				return -3;
+			game_unmake_null_move (&g, &nu);
+			if ( !test_same_state (&g, &before) ) {
+				fprintf (stderr, "test_make_unmake: lance nulo nao foi desfeito (partida %d, lance %d)\n", gi, n);
+				return -4;
+			}
+
+			line[n] = moves[test_random (&seed) % (uint64_t)count];
+			if ( game_make_move (&g, line[n], &undo[n]) != 0 )
+				return -2;
+			n++;
+
+			if ( test_check_incremental (&g, "na partida", gi, n) != 0 )
+				return -3;
+		}
+
+		while ( n > 0 ) {
+			n--;
+			game_unmake_move (&g, line[n], &undo[n]);
+		}
+
+		if ( !test_same_state (&g, start) ) {
+			fprintf (stderr, "test_make_unmake: a partida %d desfeita nao voltou ao inicio\n", gi);
+			return -4;
+		}
+	}
+
+	return 0;
+}
+
 int main (void) {
 	Game game;
 	int err;
@@ -14,7 +130,7 @@ int main (void) {
 		fprintf (stderr, "main: game_init falhou (err=%d)\n", err);
 		return 1;
 	}
-	print_graph (&(game.g));
+	print_graph (game.g);
 
 	/* mesmo tabuleiro inicial do controlador.c */
 	const char tabuleiro_inicial[] =
@@ -41,6 +157,13 @@ int main (void) {
 
 	printf ("Estado inicial carregado a partir do controlador.\n");
 
+	err = test_make_unmake (&game);
+	if ( err != 0 ) {
+		fprintf (stderr, "main: test_make_unmake falhou (err=%d)\n", err);
+		return 1;
+	}
+	printf ("make/unmake conferidos em %d partidas aleatorias.\n", TEST_GAMES);
+
 	printf ("Digite jogadas no formato do controlador (ex: \"o m 4 3 5 3\")\n");
 	printf ("Linha vazia ou EOF encerra.\n\n");
 
@@ -67,7 +190,7 @@ int main (void) {
 		}
 
 		char out[256];
-		err = game_move_to_controller (&game, &mv, out, (int)sizeof out);
+		err = game_move_to_controller (&game, mv, out, (int)sizeof out);
 		if ( err != 0 ) {
 			fprintf (stderr,
 					 "main: game_move_to_controller falhou (err=%d)\n", err);
@@ -75,8 +198,8 @@ int main (void) {
 		}
 
 		printf ("Round-trip: \"%s\" -> Move -> \"%s\"\n", line, out);
-		if ( game_is_legal_move (&game, &mv) )
-			game_apply_move (&game, &mv);
+		if ( game_is_legal_move (&game, mv) )
+			game_apply_move (&game, mv);
 		else
 			printf ("Movimento invalido: \"%s\" -> Move -> \"%s\"\n", line, out);
 
@@ -31,5 +31,14 @@ int main (void) {
 		printf ("\n");
 	}
 
+	printf ("\n=== Saltos (meio -> destino) ===\n");
+	for ( int v = 0; v < g.num_vertices; v++ ) {
+		printf ("Vertice %02d (%d,%d): ",
+				v, g.v[v].c.row, g.v[v].c.col);
+		for ( int k = 0; k < g.v[v].num_jumps; k++ )
+			printf ("%02d->%02d ", g.v[v].jumps[k].over, g.v[v].jumps[k].land);
+		printf ("\n");
+	}
+
 	return 0;
 }
@@ -0,0 +1,178 @@
+#define _DEFAULT_SOURCE /* posix_memalign, madvise */
+
+#include "tt.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#define TT_HUGE_PAGE (2u * 1024u * 1024u)
+
+_Static_assert (sizeof (TTBucket) == TT_CACHE_LINE, "TTBucket deve ocupar uma linha de cache");
+
+int tt_create (TransTable* tt, size_t size_mb) {
+	if ( !tt || size_mb == 0 ) {
+		fprintf (stderr, "tt_create: parametros invalidos\n");
+		return -1;
+	}
+
+	/* maior potencia de dois de buckets que cabe em size_mb */
+	size_t max_buckets = (size_mb * 1024u * 1024u) / sizeof (TTBucket);
+	size_t n = 1;
+	while ( n * 2 <= max_buckets )
+		n *= 2;
+
+	size_t bytes = n * sizeof (TTBucket);
+	size_t align = bytes >= TT_HUGE_PAGE ? TT_HUGE_PAGE : TT_CACHE_LINE;
+	void* mem = NULL;
+
+	if ( posix_memalign (&mem, align, bytes) != 0 ) {
+		fprintf (stderr, "tt_create: sem memoria para %zu bytes\n", bytes);
+		return -2;
+	}
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	/* so uma dica: sem suporte do kernel a tabela continua valida */
+	if ( align == TT_HUGE_PAGE )
+		madvise (mem, bytes, MADV_HUGEPAGE);
+#endif
+
+	tt->buckets = mem;
+	tt->num_buckets = n;
+	tt->bytes = bytes;
+	tt->generation = 0;
+	tt_clear (tt);
+
+	return 0;
+}
+
+void tt_destroy (TransTable* tt) {
+	if ( !tt )
+		return;
+
+	free (tt->buckets);
+	tt->buckets = NULL;
+	tt->num_buckets = 0;
+	tt->bytes = 0;
+}
+
+void tt_clear (TransTable* tt) {
+	if ( tt && tt->buckets )
+		memset (tt->buckets, 0, tt->bytes);
+}
+
+static inline TTBucket* tt_bucket (const TransTable* tt, uint64_t key) {
+	return &tt->buckets[key & (tt->num_buckets - 1)];
+}
+
+void tt_new_search (TransTable* tt) {
+	tt->generation = (tt->generation + 1) % TT_GENERATIONS;
+}
+
+static inline uint32_t tt_pack (int depth, TTBound bound, int score, unsigned generation) {
+	return ((uint32_t)(uint16_t)score << 16) | ((uint32_t)(uint8_t)depth << 8) | (generation << 2) | (uint32_t)bound;
+}
+
+static inline int tt_data_bound (uint32_t data) {
+	return (int)(data & 3);
+}
+
+static inline int tt_data_depth (uint32_t data) {
+	return (int)((data >> 8) & 0xff);
+}
+
+static inline unsigned tt_data_generation (uint32_t data) {
+	return (data >> 2) & (TT_GENERATIONS - 1);
+}
+
+/* le a entrada i; 1 se ela guarda key e nao foi misturada com outra escrita */
+static inline int tt_read (const TTBucket* b, int i, uint64_t key, TTEntry* out) {
+	uint64_t check = atomic_load_explicit (&b->check[i], memory_order_relaxed);
+	uint64_t move = atomic_load_explicit (&b->move[i], memory_order_relaxed);
+	uint32_t data = atomic_load_explicit (&b->data[i], memory_order_relaxed);
+
+	if ( (check ^ move ^ data) != key || tt_data_bound (data) == TT_NONE )
+		return 0;
+
+	out->key = key;
+	out->move = move;
+	out->score = (int16_t)(uint16_t)(data >> 16);
+	out->depth = (int16_t)tt_data_depth (data);
+	out->bound = (uint8_t)tt_data_bound (data);
+	return 1;
+}
+
+static inline void tt_write (TTBucket* b, int i, uint64_t key, Move move, uint32_t data) {
+	atomic_store_explicit (&b->check[i], key ^ move ^ data, memory_order_relaxed);
+	atomic_store_explicit (&b->move[i], move, memory_order_relaxed);
+	atomic_store_explicit (&b->data[i], data, memory_order_relaxed);
+}
+
+int tt_probe (const TransTable* tt, uint64_t key, TTEntry* out) {
+	const TTBucket* b = tt_bucket (tt, key);
+
+	for ( int i = 0; i < TT_BUCKET_ENTRIES; i++ ) {
+		if ( tt_read (b, i, key, out) )
+			return 1;
+	}
+
+	return 0;
+}
+
+/* valor de uma entrada para ficar: vazia (ou misturada) vale -1; de outra
+   busca, pouco acima disso */
+static inline int tt_keep_value (const TransTable* tt, uint32_t data) {
+	if ( tt_data_bound (data) == TT_NONE )
+		return -1;
+	if ( tt_data_generation (data) != tt->generation )
+		return tt_data_depth (data) - 256;
+	return tt_data_depth (data);
+}
+
+void tt_store (TransTable* tt, uint64_t key, int depth, TTBound bound, int score, Move move) {
+	TTBucket* b = tt_bucket (tt, key);
+	uint32_t data = tt_pack (depth, bound, score, tt->generation);
+	TTEntry old;
+
+	/* mesma posicao: atualiza onde ela ja esta. Um resultado mais raso e
+	 * nao exato nao apaga o mais profundo; so o movimento e a geracao sao
+	 * renovados */
+	for ( int i = 0; i < TT_BUCKET_ENTRIES; i++ ) {
+		if ( tt_read (b, i, key, &old) ) {
+			if ( bound != TT_EXACT && depth < old.depth ) {
+				tt_write (b, i, key, move == MOVE_NONE ? old.move : move,
+						  tt_pack (old.depth, old.bound, old.score, tt->generation));
+				return;
+			}
+			tt_write (b, i, key, move == MOVE_NONE ? old.move : move, data);
+			return;
+		}
+	}
+
+	/* entre as sempre-substitui, sai a menos valiosa */
+	uint32_t data1 = atomic_load_explicit (&b->data[1], memory_order_relaxed);
+	uint32_t data2 = atomic_load_explicit (&b->data[2], memory_order_relaxed);
+	int victim = tt_keep_value (tt, data2) < tt_keep_value (tt, data1) ? 2 : 1;
+
+	/* entrada preferida: cede a uma profundidade maior ou igual, ou se for velha */
+	uint64_t deep_check = atomic_load_explicit (&b->check[0], memory_order_relaxed);
+	uint64_t deep_move = atomic_load_explicit (&b->move[0], memory_order_relaxed);
+	uint32_t deep_data = atomic_load_explicit (&b->data[0], memory_order_relaxed);
+	int deep_empty = tt_data_bound (deep_data) == TT_NONE;
+	int deep_old = tt_data_generation (deep_data) != tt->generation;
+
+	if ( deep_empty || deep_old || depth >= tt_data_depth (deep_data) ) {
+		/* a entrada profunda desta busca ainda vale como sempre-substitui */
+		if ( !deep_empty && !deep_old ) {
+			uint64_t deep_key = deep_check ^ deep_move ^ deep_data;
+			tt_write (b, victim, deep_key, deep_move, deep_data);
+		}
+		tt_write (b, 0, key, move, data);
+	} else {
+		tt_write (b, victim, key, move, data);
+	}
+}
@@ -0,0 +1,125 @@
+#ifndef TT_H
+#define TT_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+
+#define TT_CACHE_LINE 64 /* bytes por bucket (uma linha de cache) */
+#define TT_BUCKET_ENTRIES 3
+#define TT_GENERATIONS 64 /* geracoes distintas guardadas em cada entrada (6 bits) */
+
+/**
+ * @brief Tipo do limite guardado em uma entrada da tabela.
+ */
+typedef enum {
+	TT_NONE = 0,  /* entrada vazia                              */
+	TT_EXACT = 1, /* valor exato                                */
+	TT_LOWER = 2, /* valor >= score (corte beta)                */
+	TT_UPPER = 3  /* valor <= score (nenhum movimento superou alfa) */
+} TTBound;
+
+/**
+ * @brief Conteudo de uma entrada da tabela, como devolvido por tt_probe.
+ *
+ * O score eh guardado do ponto de vista de quem joga na posicao, para
+ * que a mesma entrada sirva quando a IA troca de lado entre buscas.
+ */
+typedef struct {
+	uint64_t key; /* chave Zobrist completa (Game.key) */
+	Move move;	  /* melhor movimento, ou MOVE_NONE    */
+
+	int32_t score;
+	int16_t depth;
+	uint8_t bound; /* TTBound */
+} TTEntry;
+
+/**
+ * @brief Bucket do tamanho de uma linha de cache, com tres entradas sem trava.
+ *
+ * A entrada i ocupa check[i], move[i] e data[i] (20 bytes; os vetores
+ * separados evitam o preenchimento que um struct por entrada teria).
+ * Varias threads leem e escrevem a tabela ao mesmo tempo. Cada palavra eh
+ * atomica, mas a entrada inteira nao: uma leitura pode misturar palavras
+ * de duas escritas. Por isso guardamos check = key ^ move ^ data e so
+ * aceitamos a entrada se check ^ move ^ data reproduz a chave procurada.
+ *
+ * A entrada 0 so da lugar a uma profundidade maior ou igual, ou quando eh
+ * de uma busca anterior (geracao velha); as entradas 1 e 2 sao sempre
+ * substituidas, a de geracao mais velha ou mais rasa primeiro.
+ */
+typedef struct {
+	_Alignas (TT_CACHE_LINE) _Atomic uint64_t check[TT_BUCKET_ENTRIES]; /* key ^ move ^ data */
+	_Atomic uint64_t move[TT_BUCKET_ENTRIES]; /* Move */
+	_Atomic uint32_t data[TT_BUCKET_ENTRIES]; /* score (16) | depth (8) | geracao (6) | bound (2) */
+} TTBucket;
+
+/**
+ * @brief Tabela de transposicao de tamanho fixo (potencia de dois).
+ */
+typedef struct {
+	TTBucket* buckets;
+	size_t num_buckets; /* potencia de dois */
+	size_t bytes;		/* tamanho alocado  */
+	unsigned generation; /* busca atual, modulo TT_GENERATIONS (tt_new_search) */
+} TransTable;
+
+/**
+ * @brief Aloca a tabela com ate size_mb megabytes.
+ *
+ * O numero de buckets eh arredondado para baixo ate uma potencia de dois.
+ * Em Linux, tabelas grandes pedem paginas enormes (madvise) ao kernel.
+ *
+ * @param tt      Tabela (saida).
+ * @param size_mb Tamanho em MB (>= 1).
+ * @return 0 em sucesso, <0 em erro.
+ */
+int tt_create (TransTable* tt, size_t size_mb);
+
+/**
+ * @brief Libera a memoria da tabela.
+ */
+void tt_destroy (TransTable* tt);
+
+/**
+ * @brief Apaga todas as entradas (nenhuma busca pode estar usando a tabela).
+ */
+void tt_clear (TransTable* tt);
+
+/**
+ * @brief Comeca uma nova busca: entradas gravadas antes ficam velhas.
+ *
+ * Entradas velhas continuam valendo nas consultas, mas cedem o lugar a
+ * qualquer entrada nova. Chamar sem nenhuma busca usando a tabela.
+ */
+void tt_new_search (TransTable* tt);
+
+/**
+ * @brief Procura a posicao de chave key (seguro com escritas concorrentes).
+ *
+ * @param tt  Tabela.
+ * @param key Chave Zobrist.
+ * @param out Copia da entrada encontrada.
+ * @return 1 se encontrou, 0 caso contrario.
+ */
+int tt_probe (const TransTable* tt, uint64_t key, TTEntry* out);
+
+/**
+ * @brief Guarda o resultado da busca de uma posicao (sem trava).
+ *
+ * Se a posicao ja estiver no bucket, a entrada eh atualizada (mantendo o
+ * movimento antigo quando move == MOVE_NONE) se o novo resultado for exato
+ * ou tiver pelo menos a profundidade guardada; senao so o movimento e a
+ * geracao sao renovados e o resultado mais profundo fica. Senao, vai para
+ * a entrada 0 se depth for pelo menos a profundidade ali guardada ou se
+ * ela for de outra busca (a entrada deslocada desce para uma das entradas
+ * sempre-substitui), ou direto para uma entrada sempre-substitui.
+ *
+ * @param depth Profundidade restante (0 a 255).
+ * @param score Valor do ponto de vista de quem joga na posicao (cabe em 16 bits).
+ */
+void tt_store (TransTable* tt, uint64_t key, int depth, TTBound bound, int score, Move move);
+
+#endif /* TT_H */